@@ -45,17 +45,26 @@
 #define AVIGLE__IO__CMVS_READER_H_
 
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/tokenizer.hpp>
 
+#include <io/dataset_info.h>
+#include <io/image_probe.h>
 #include <io/io_api.h>
 #include <io/input_adapter_interface.h>
+#include <io/load_options.h>
+#include <io/mapped_file.h>
+#include <io/parallel_tools.h>
+#include <io/point_batch.h>
 #include <io/reader_tools.h>
+#include <io/work_stealing_pool.h>
 
 
 namespace io
@@ -69,9 +78,12 @@ class IO_API CmvsReader
   friend class InputData;
 
 private:
-  CmvsReader(const std::string& fileName);
+  CmvsReader(const std::string& fileName,
+             const io::LoadOptions& loadOptions = io::LoadOptions());
   ~CmvsReader();
 
+  void Probe(io::DatasetInfo* pInfo);
+
   template <typename FloatType>
   void Load(InputAdapterInterface<FloatType>* pInputAdapter);
 
@@ -90,11 +102,42 @@ private:
     }
   };
 
+  /// One numbered cluster directory (00, 01, ...) written by CMVS/PMVS.
+  struct Cluster
+  {
+    boost::filesystem::path fCamerasPath;
+    boost::filesystem::path fPatchesPath;
+    boost::filesystem::path fTextureImagePath;
+    boost::filesystem::path fProjectionMatrixFolder;
+  };
+
+  template <class FloatType>
+  struct Camera
+  {
+    std::string fTextureFileName;
+    FloatType fPosition[3];
+    FloatType fDirection[3];
+    Matrix3x4<FloatType> fProjection;
+    /// The tokens of the projection matrix as written, separated by spaces.
+    /// Identifies the camera across clusters whatever FloatType is.
+    std::string fProjectionKey;
+  };
+
+  template <typename FloatType>
+  static void LoadCameras(const Cluster* pCluster,
+                          std::vector<Camera<FloatType> >* pCameras);
+
+  template <typename FloatType>
+  static void LoadPatches(
+    const boost::filesystem::path& patchesFilePath,
+    const std::vector<Camera<FloatType> >* pCameras,
+    const std::vector<unsigned int>* pTextureIds,
+    io::ThreadBatchBuffers<FloatType>* pBatchBuffers,
+    unsigned int thread);
+
   boost::filesystem::path fInputPath;
-  boost::filesystem::path fCamerasPath;
-  boost::filesystem::path fPatchesPath;
-  boost::filesystem::path fTextureImagePath;
-  boost::filesystem::path fProjectionMatrixFolder;
+  std::vector<Cluster> fClusters;
+  io::LoadOptions fLoadOptions;
 };  // class
 
 
@@ -110,50 +153,196 @@ CmvsReader::Load
 (InputAdapterInterface<FloatType>* pInputAdapter)
 {
   namespace bf = boost::filesystem;
-  namespace iort = io::ReaderTools;
 
-  std::map<unsigned int, Matrix3x4<FloatType> > projectionMatrices;
+  const std::size_t numClusters = this->fClusters.size();
+  io::WorkStealingPool pool(this->fLoadOptions.fNumThreads);
 
   // TEXTURES
-  std::ifstream camerasStream(this->fCamerasPath.c_str());
-  if (!camerasStream.is_open())
+  std::vector<std::vector<Camera<FloatType> > > cameras(numClusters);
+  std::vector<io::WorkStealingPool::Task> cameraTasks;
+  for (std::size_t cluster = 0u; cluster < numClusters; ++cluster)
+  {
+    cameraTasks.push_back(boost::bind(&CmvsReader::LoadCameras<FloatType>,
+                                      &this->fClusters[cluster],
+                                      &cameras[cluster]));
+  }
+  pool.Run(cameraTasks);
+
+  // Clusters overlap and number their images independently. A camera seen by
+  // several clusters has the same projection matrix in all of them, so the
+  // matrix identifies the texture across clusters. It is compared as written
+  // (see Camera::fProjectionKey), so Probe() finds the same textures.
+  std::map<std::string, unsigned int> textureIdByProjection;
+  std::vector<std::vector<unsigned int> > textureIds(numClusters);
+  std::vector<const Camera<FloatType>*> textures;
+  for (std::size_t cluster = 0u; cluster < numClusters; ++cluster)
+  {
+    const std::vector<Camera<FloatType> >& clusterCameras = cameras[cluster];
+    textureIds[cluster].reserve(clusterCameras.size());
+    for (std::size_t texNum = 0u; texNum < clusterCameras.size(); ++texNum)
+    {
+      const Camera<FloatType>& camera = clusterCameras[texNum];
+
+      const unsigned int textureId =
+        static_cast<unsigned int>(textureIdByProjection.size());
+      const std::pair<std::map<std::string, unsigned int>::iterator,
+                      bool> inserted =
+        textureIdByProjection.insert(
+          std::make_pair(camera.fProjectionKey, textureId));
+      textureIds[cluster].push_back(inserted.first->second);
+      if (inserted.second)
+      {
+        textures.push_back(&camera);
+      }
+    } // for camera
+  } // for all clusters
+
+  // image sizes, 0 x 0 for images that cannot be read
+  std::vector<std::string> textureFileNames;
+  textureFileNames.reserve(textures.size());
+  for (std::size_t textureId = 0u; textureId < textures.size(); ++textureId)
+  {
+    textureFileNames.push_back(textures[textureId]->fTextureFileName);
+  }
+  std::vector<unsigned int> textureWidths;
+  std::vector<unsigned int> textureHeights;
+  io::ImageProbe imageProbe(this->fLoadOptions);
+  imageProbe.GetSizes(textureFileNames, &textureWidths, &textureHeights,
+                      this->fLoadOptions.fNumThreads);
+
+  // store textures, numbered in order of appearance
+  pInputAdapter->OnBeginTextures(textures.size());
+  for (std::size_t textureId = 0u; textureId < textures.size(); ++textureId)
+  {
+    const Camera<FloatType>& camera = *textures[textureId];
+    const Matrix3x4<FloatType>& projection = camera.fProjection;
+    pInputAdapter->OnTexture(static_cast<unsigned int>(textureId),
+                             camera.fTextureFileName,
+                             textureWidths[textureId],
+                             textureHeights[textureId],
+                             camera.fPosition[0],
+                             camera.fPosition[1],
+                             camera.fPosition[2],
+                             camera.fDirection[0],
+                             camera.fDirection[1],
+                             camera.fDirection[2],
+                             projection.m[0][0],
+                             projection.m[0][1],
+                             projection.m[0][2],
+                             projection.m[1][0],
+                             projection.m[1][1],
+                             projection.m[1][2],
+                             projection.m[2][0],
+                             projection.m[2][1],
+                             projection.m[2][2],
+                             -projection.m[0][3],
+                             -projection.m[1][3],
+                             -projection.m[2][3],
+                             static_cast<FloatType>(0.0),
+                             static_cast<FloatType>(0.0));
+  } // for texture
+
+
+  // POINTS
+  // Every .patch/.ply pair of every cluster is one task. Pairs differ a lot
+  // in size, so idle threads steal pending pairs from busy ones.
+  io::ThreadBatchBuffers<FloatType> batchBuffers(pool.GetNumThreads(),
+                                                 pInputAdapter);
+  std::vector<io::WorkStealingPool::Task> patchTasks;
+  std::size_t numPoints = 0u;
+  for (std::size_t cluster = 0u; cluster < numClusters; ++cluster)
+  {
+    bf::directory_iterator patchesDirIter(this->fClusters[cluster].fPatchesPath);
+    bf::directory_iterator patchesDirEnd;
+    for (; patchesDirIter != patchesDirEnd; ++patchesDirIter)
+    {
+      if (patchesDirIter->path().extension().compare(std::string(".patch")) == 0)
+      {
+        patchTasks.push_back(boost::bind(&CmvsReader::LoadPatches<FloatType>,
+                                         patchesDirIter->path(),
+                                         &cameras[cluster],
+                                         &textureIds[cluster],
+                                         &batchBuffers,
+                                         _1));
+        numPoints += io::ReaderTools::CountPatches(
+          patchesDirIter->path().string());
+      } // if .patch file
+    } // for all .patch files
+  } // for all clusters
+
+  pInputAdapter->OnBeginPoints(numPoints);
+  pool.Run(patchTasks);
+  batchBuffers.FlushAll();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the cameras of one cluster together with their projection matrices.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+CmvsReader::LoadCameras
+(const Cluster* pCluster,
+ std::vector<Camera<FloatType> >* pCameras)
+{
+  namespace bf = boost::filesystem;
+  namespace iort = io::ReaderTools;
+
+  io::MappedFile camerasFile(pCluster->fCamerasPath.string());
+  if (!camerasFile.IsOpen())
   {
     std::cerr << "Could not open cameras file!" << std::endl;
     std::cerr << "Terminating." << std::endl;
     exit(EXIT_FAILURE);
   }
-  const unsigned int numOfTextures = iort::Line<unsigned int>(camerasStream);
+  const unsigned int numOfTextures = iort::Line<unsigned int>(camerasFile);
+  pCameras->resize(numOfTextures);
   for (unsigned int texNum = 0; texNum < numOfTextures; ++texNum)
   {
+    Camera<FloatType>& camera = (*pCameras)[texNum];
+
     const bf::path textureFilePath(
-      bf::absolute(iort::Line<std::string>(camerasStream),
-                   this->fTextureImagePath));
-
-    iort::Line<iort::Unused>(camerasStream);                  // focal length
-    iort::Line<iort::Unused>(camerasStream);                  // principal point
-    iort::Line<iort::Unused>(camerasStream);                  // translation
-    iort::Tokens posTokens(iort::Line(camerasStream, " \t")); // position
-    iort::Line<iort::Unused>(camerasStream);                  // axis angle
-    iort::Line<iort::Unused>(camerasStream);                  // quaternion
-    iort::Line<iort::Unused>(camerasStream);                  // 1st row of 3x3 matrix
-    iort::Line<iort::Unused>(camerasStream);                  // 2nd row of 3x3 matrix
-    iort::Tokens dirTokens(iort::Line(camerasStream, " \t")); // 3rd: direction
+      bf::absolute(iort::Line<std::string>(camerasFile),
+                   pCluster->fTextureImagePath));
+    camera.fTextureFileName = textureFilePath.string();
+
+    iort::Line<iort::Unused>(camerasFile);                  // focal length
+    iort::Line<iort::Unused>(camerasFile);                  // principal point
+    iort::Line<iort::Unused>(camerasFile);                  // translation
+    iort::Tokens posTokens(iort::Line(camerasFile, " \t")); // position
+    iort::Line<iort::Unused>(camerasFile);                  // axis angle
+    iort::Line<iort::Unused>(camerasFile);                  // quaternion
+    iort::Line<iort::Unused>(camerasFile);                  // 1st row of 3x3 matrix
+    iort::Line<iort::Unused>(camerasFile);                  // 2nd row of 3x3 matrix
+    iort::Tokens dirTokens(iort::Line(camerasFile, " \t")); // 3rd: direction
+
+    for (unsigned int coord = 0u; coord < 3u; ++coord)
+    {
+      camera.fPosition[coord] = iort::Token<FloatType>(posTokens);
+    }
+    for (unsigned int coord = 0u; coord < 3u; ++coord)
+    {
+      camera.fDirection[coord] = iort::Token<FloatType>(dirTokens);
+    }
 
     // determine projection matrix
     bf::path projectionMatrixFile(textureFilePath.stem());
     projectionMatrixFile += ".txt";
     projectionMatrixFile =
-    bf::absolute(projectionMatrixFile, this->fProjectionMatrixFolder);
+    bf::absolute(projectionMatrixFile, pCluster->fProjectionMatrixFolder);
 
-    std::ifstream projectionMatrixStream(projectionMatrixFile.c_str());
-    if (!projectionMatrixStream.is_open())
+    io::MappedFile projectionMatrixInput(projectionMatrixFile.string());
+    if (!projectionMatrixInput.IsOpen())
     {
       std::cerr << "Could not open projection matrix file!" << std::endl;
       std::cerr << "Terminating." << std::endl;
       exit(EXIT_FAILURE);
     }
 
-    const std::string magic(iort::Line<std::string>(projectionMatrixStream));
+    const std::string magic(iort::Line<std::string>(projectionMatrixInput));
     if (magic.compare("CONTOUR") != 0)
     {
       std::cerr << "Invalid projection matrix file!" << std::endl;
@@ -161,179 +350,159 @@ CmvsReader::Load
       exit(EXIT_FAILURE);
     }
 
-    iort::Tokens fstRowTokens(iort::Line(projectionMatrixStream, " \t"));
-    iort::Tokens sndRowTokens(iort::Line(projectionMatrixStream, " \t"));
-    iort::Tokens trdRowTokens(iort::Line(projectionMatrixStream, " \t"));
-
-    projectionMatrices[texNum] =
-    Matrix3x4<FloatType>(iort::Token<FloatType>(fstRowTokens),
-                         iort::Token<FloatType>(fstRowTokens),
-                         iort::Token<FloatType>(fstRowTokens),
-                         iort::Token<FloatType>(fstRowTokens),
-                         iort::Token<FloatType>(sndRowTokens),
-                         iort::Token<FloatType>(sndRowTokens),
-                         iort::Token<FloatType>(sndRowTokens),
-                         iort::Token<FloatType>(sndRowTokens),
-                         iort::Token<FloatType>(trdRowTokens),
-                         iort::Token<FloatType>(trdRowTokens),
-                         iort::Token<FloatType>(trdRowTokens),
-                         iort::Token<FloatType>(trdRowTokens));
-    if (projectionMatrixStream.is_open())
+    iort::Tokens rowTokens(" \t");
+    camera.fProjectionKey.clear();
+    for (unsigned int row = 0u; row < 3u; ++row)
     {
-      projectionMatrixStream.close();
+      iort::Line(projectionMatrixInput, &rowTokens);
+      for (unsigned int column = 0u; column < 4u; ++column)
+      {
+        const std::string value(iort::Token<std::string>(rowTokens));
+        camera.fProjection.m[row][column] =
+          iort::Parse<FloatType>(value.data(), value.data() + value.size());
+        camera.fProjectionKey += value;
+        camera.fProjectionKey += ' ';
+      }
     }
+  } // for camera
+}
 
-    // store texture
-    pInputAdapter->OnTexture(texNum,
-                             textureFilePath.string(),
-                             0u, 0u,
-                             iort::Token<FloatType>(posTokens),
-                             iort::Token<FloatType>(posTokens),
-                             iort::Token<FloatType>(posTokens),
-                             iort::Token<FloatType>(dirTokens),
-                             iort::Token<FloatType>(dirTokens),
-                             iort::Token<FloatType>(dirTokens),
-                             projectionMatrices[texNum].m[0][0],
-                             projectionMatrices[texNum].m[0][1],
-                             projectionMatrices[texNum].m[0][2],
-                             projectionMatrices[texNum].m[1][0],
-                             projectionMatrices[texNum].m[1][1],
-                             projectionMatrices[texNum].m[1][2],
-                             projectionMatrices[texNum].m[2][0],
-                             projectionMatrices[texNum].m[2][1],
-                             projectionMatrices[texNum].m[2][2],
-                             -projectionMatrices[texNum].m[0][3],
-                             -projectionMatrices[texNum].m[1][3],
-                             -projectionMatrices[texNum].m[2][3],
-                             static_cast<FloatType>(0.0),
-                             static_cast<FloatType>(0.0));
 
 
 
-  } // for camera
-  if (camerasStream.is_open())
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses one .patch file and its accompanying .ply file into the batch of
+/// the given thread. Texture ids are mapped to the shared texture table.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+CmvsReader::LoadPatches
+(const boost::filesystem::path& patchesFilePath,
+ const std::vector<Camera<FloatType> >* pCameras,
+ const std::vector<unsigned int>* pTextureIds,
+ io::ThreadBatchBuffers<FloatType>* pBatchBuffers,
+ unsigned int thread)
+{
+  namespace bf = boost::filesystem;
+  namespace iort = io::ReaderTools;
+
+  // get accompanying ply file
+  bf::path pointsFile(patchesFilePath);
+  pointsFile.replace_extension(std::string(".ply"));
+
+  io::MappedFile patchesFile(patchesFilePath.string());
+  io::MappedFile pointsInput(pointsFile.string());
+
+  if (!(patchesFile.IsOpen() && pointsInput.IsOpen()))
   {
-    camerasStream.close();
+    std::cerr << "Could not open patches files!" << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
   }
 
-
-  // POINTS
-  bf::directory_iterator patchesDirIter(this->fPatchesPath);
-  bf::directory_iterator patchesDirEnd;
-  for (; patchesDirIter != patchesDirEnd; ++patchesDirIter)
+  const std::string magic(iort::Line<std::string>(patchesFile));
+  if (magic.compare("PATCHES") != 0)
   {
-    if (patchesDirIter->path().extension().compare(std::string(".patch")) == 0)
-    {
-      // get accompanying ply file
-      bf::path pointsFile(patchesDirIter->path());
-      pointsFile.replace_extension(std::string(".ply"));
+    std::cerr << "Invalid patches file!" << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
 
-      std::ifstream patchesStream(patchesDirIter->path().c_str());
-      std::ifstream pointsStream(pointsFile.c_str());
+  const unsigned int numPatches = iort::Line<unsigned int>(patchesFile);
 
-      if (!(patchesStream.is_open() && pointsStream.is_open()))
-      {
-        std::cerr << "Could not open patches files!" << std::endl;
-        std::cerr << "Terminating." << std::endl;
-        exit(EXIT_FAILURE);
-      }
+  iort::Line<iort::Unused>(pointsInput);   // ply
+  iort::Line<iort::Unused>(pointsInput);   // format ascii #
 
-      const std::string magic(iort::Line<std::string>(patchesStream));
-      if (magic.compare("PATCHES") != 0)
-      {
-        std::cerr << "Invalid patches file!" << std::endl;
-        std::cerr << "Terminating." << std::endl;
-        exit(EXIT_FAILURE);
-      }
+  iort::Tokens numPointTokens(iort::Line(pointsInput, " \t"));
+  iort::Token<iort::Unused>(numPointTokens);  // element
+  iort::Token<iort::Unused>(numPointTokens);  // vertex
+  unsigned int numPoints =
+    iort::Token<unsigned int>(numPointTokens);
 
-      const unsigned int numPatches = iort::Line<unsigned int>(patchesStream);
+  if (numPatches != numPoints)
+  {
+    std::cerr << "Different numbers of points and patches!" << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
 
-      iort::Line<iort::Unused>(pointsStream);   // ply
-      iort::Line<iort::Unused>(pointsStream);   // format ascii #
+  // seek beginning point definition in ply file
+  while(iort::Line<std::string>(pointsInput).compare("end_header") != 0);
 
-      iort::Tokens numPointTokens(iort::Line(pointsStream, " \t"));
-      iort::Token<iort::Unused>(numPointTokens);  // element
-      iort::Token<iort::Unused>(numPointTokens);  // vertex
-      unsigned int numPoints =
-        iort::Token<unsigned int>(numPointTokens);
+  const std::vector<Camera<FloatType> >& cameras = *pCameras;
+  const std::vector<unsigned int>& textureIds = *pTextureIds;
 
-      if (numPatches != numPoints)
+  io::PointBatch<FloatType>& batch = pBatchBuffers->GetBatch(thread);
+  iort::Tokens pointTokens(" \t");
+  iort::Tokens textures(" \t");
+  for (unsigned int pointId = 0; pointId < numPoints; ++pointId)
+  {
+    iort::Line(pointsInput, &pointTokens);
+
+    const FloatType pointPosX = iort::Token<FloatType>(pointTokens);
+    const FloatType pointPosY = iort::Token<FloatType>(pointTokens);
+    const FloatType pointPosZ = iort::Token<FloatType>(pointTokens);
+    batch.AddPosition(pointPosX, pointPosY, pointPosZ);
+
+    iort::Token<iort::Unused>(pointTokens); // nx
+    iort::Token<iort::Unused>(pointTokens); // ny
+    iort::Token<iort::Unused>(pointTokens); // nz
+
+    const FloatType pointColR =
+      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+    const FloatType pointColG =
+      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+    const FloatType pointColB =
+      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+    batch.AddColour(pointColR, pointColG, pointColB);
+
+    // seek next patch in patch file
+    while(iort::Line<std::string>(patchesFile).compare("PATCHS") != 0);
+
+    iort::Line<iort::Unused>(patchesFile); // position
+    iort::Line<iort::Unused>(patchesFile); // normal
+    iort::Line<iort::Unused>(patchesFile); // confidence and debug
+
+    const unsigned int numCoords = iort::Line<unsigned int>(patchesFile);
+    iort::Line(patchesFile, &textures);
+    for (unsigned int texCoord = 0u; texCoord < numCoords; ++texCoord)
+    {
+      const unsigned int localTextureId = iort::Token<unsigned int>(textures);
+      if (localTextureId >= cameras.size())
       {
-        std::cerr << "Different numbers of points and patches!" << std::endl;
+        std::cerr << "Invalid texture id " << localTextureId
+                  << " in patches file " << patchesFilePath.string() << "!"
+                  << std::endl;
         std::cerr << "Terminating." << std::endl;
         exit(EXIT_FAILURE);
       }
-
-      // seek beginning point definition in ply file
-      while(iort::Line<std::string>(pointsStream).compare("end_header") != 0);
-
-      for (unsigned int pointId = 0; pointId < numPoints; ++pointId)
-      {
-        iort::Tokens pointTokens(iort::Line(pointsStream, " \t"));
-
-        pInputAdapter->OnBeginPoint();
-        const FloatType pointPosX = iort::Token<FloatType>(pointTokens);
-        const FloatType pointPosY = iort::Token<FloatType>(pointTokens);
-        const FloatType pointPosZ = iort::Token<FloatType>(pointTokens);
-        pInputAdapter->OnPointPosition(pointPosX, pointPosY, pointPosZ);
-
-        iort::Token<iort::Unused>(pointTokens); // nx
-        iort::Token<iort::Unused>(pointTokens); // ny
-        iort::Token<iort::Unused>(pointTokens); // nz
-
-        const FloatType pointColR =
-          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
-        const FloatType pointColG =
-          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);;
-        const FloatType pointColB =
-          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);;
-        pInputAdapter->OnPointColour(pointColR, pointColG, pointColB);
-
-        // seek next patch in patch file
-        while(iort::Line<std::string>(patchesStream).compare("PATCHS") != 0);
-
-        iort::Line<iort::Unused>(patchesStream); // position
-        iort::Line<iort::Unused>(patchesStream); // normal
-        iort::Line<iort::Unused>(patchesStream); // confidence and debug
-
-        const unsigned int numCoords = iort::Line<unsigned int>(patchesStream);
-        iort::Tokens textures(iort::Line(patchesStream, " \t"));
-        for (unsigned int texCoord = 0u; texCoord < numCoords; ++texCoord)
-        {
-          const unsigned int textureId = iort::Token<unsigned int>(textures);
-          const Matrix3x4<FloatType> projection = projectionMatrices[textureId];
-
-          const FloatType depth =
-            projection.m[2][0] * pointPosX +
-            projection.m[2][1] * pointPosY +
-            projection.m[2][2] * pointPosZ +
-            projection.m[2][3];
-          const FloatType u =
-            (projection.m[0][0] * pointPosX +
-             projection.m[0][1] * pointPosY +
-             projection.m[0][2] * pointPosZ +
-             projection.m[0][3]) / depth;
-
-          const FloatType v =
-            (projection.m[1][0] * pointPosX +
-             projection.m[1][1] * pointPosY +
-             projection.m[1][2] * pointPosZ +
-             projection.m[1][3]) / depth;
-
-          pInputAdapter->OnPointTexCoord(textureId, u, v);
-        } // for all tex coords per point
-        pInputAdapter->OnEndPoint();
-      } // for all points
-      if (patchesStream.is_open())
-      {
-        patchesStream.close();
-      }
-      if (pointsStream.is_open())
-      {
-        pointsStream.close();
-      }
-    } // if .patch file
-  } // for all .patch files
+      const unsigned int textureId = textureIds[localTextureId];
+      const Matrix3x4<FloatType>& projection =
+        cameras[localTextureId].fProjection;
+
+      const FloatType depth =
+        projection.m[2][0] * pointPosX +
+        projection.m[2][1] * pointPosY +
+        projection.m[2][2] * pointPosZ +
+        projection.m[2][3];
+      const FloatType u =
+        (projection.m[0][0] * pointPosX +
+         projection.m[0][1] * pointPosY +
+         projection.m[0][2] * pointPosZ +
+         projection.m[0][3]) / depth;
+
+      const FloatType v =
+        (projection.m[1][0] * pointPosX +
+         projection.m[1][1] * pointPosY +
+         projection.m[1][2] * pointPosZ +
+         projection.m[1][3]) / depth;
+
+      batch.AddTexCoord(textureId, u, v);
+    } // for all tex coords per point
+    batch.EndPoint();
+    pBatchBuffers->FlushIfFull(thread);
+  } // for all points
 }
 
 
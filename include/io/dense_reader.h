@@ -51,10 +51,12 @@
 #include <string>
 
 #include <boost/filesystem.hpp>
-#include <boost/tokenizer.hpp>
 
+#include <io/dataset_info.h>
 #include <io/io_api.h>
 #include <io/input_adapter_interface.h>
+#include <io/mapped_file.h>
+#include <io/point_batch.h>
 #include <io/reader_tools.h>
 
 
@@ -72,6 +74,8 @@ private:
   DenseReader(const std::string& fileName);
   ~DenseReader();
 
+  void Probe(io::DatasetInfo* pInfo);
+
   template <typename FloatType>
   void Load(InputAdapterInterface<FloatType>* pInputAdapter);
 
@@ -94,8 +98,22 @@ DenseReader::Load
   namespace iort = io::ReaderTools;
 
   // POINTS
-  bf::directory_iterator patchesDirIter(this->fInputPath);
   bf::directory_iterator patchesDirEnd;
+
+  // the points are spread over all .patch files, announce their sum
+  std::size_t numOfPoints = 0u;
+  bf::directory_iterator countDirIter(this->fInputPath);
+  for (; countDirIter != patchesDirEnd; ++countDirIter)
+  {
+    if (countDirIter->path().extension().compare(std::string(".patch")) == 0)
+    {
+      numOfPoints += iort::CountPatches(countDirIter->path().string());
+    }
+  }
+  pInputAdapter->OnBeginPoints(numOfPoints);
+
+  io::PointBatch<FloatType> batch;
+  bf::directory_iterator patchesDirIter(this->fInputPath);
   for (; patchesDirIter != patchesDirEnd; ++patchesDirIter)
   {
     if (patchesDirIter->path().extension().compare(std::string(".patch")) == 0)
@@ -104,17 +122,17 @@ DenseReader::Load
       bf::path pointsFile(patchesDirIter->path());
       pointsFile.replace_extension(std::string(".ply"));
 
-      std::ifstream patchesStream(patchesDirIter->path().c_str());
-      std::ifstream pointsStream(pointsFile.c_str());
+      io::MappedFile patchesFile(patchesDirIter->path().string());
+      io::MappedFile pointsInput(pointsFile.string());
 
-      if (!(patchesStream.is_open() && pointsStream.is_open()))
+      if (!(patchesFile.IsOpen() && pointsInput.IsOpen()))
       {
         std::cerr << "Could not open patches files!" << std::endl;
         std::cerr << "Terminating." << std::endl;
         exit(EXIT_FAILURE);
       }
 
-      const std::string magic(iort::Line<std::string>(patchesStream));
+      const std::string magic(iort::Line<std::string>(patchesFile));
       if (magic.compare("PATCHES") != 0)
       {
         std::cerr << "Invalid patches file!" << std::endl;
@@ -122,12 +140,12 @@ DenseReader::Load
         exit(EXIT_FAILURE);
       }
 
-      const unsigned int numPatches = iort::Line<unsigned int>(patchesStream);
+      const unsigned int numPatches = iort::Line<unsigned int>(patchesFile);
 
-      iort::Line<iort::Unused>(pointsStream);   // ply
-      iort::Line<iort::Unused>(pointsStream);   // format ascii #
+      iort::Line<iort::Unused>(pointsInput);   // ply
+      iort::Line<iort::Unused>(pointsInput);   // format ascii #
 
-      iort::Tokens numPointTokens(iort::Line(pointsStream, " \t"));
+      iort::Tokens numPointTokens(iort::Line(pointsInput, " \t"));
       iort::Token<iort::Unused>(numPointTokens);  // element
       iort::Token<iort::Unused>(numPointTokens);  // vertex
       unsigned int numPoints =
@@ -141,17 +159,18 @@ DenseReader::Load
       }
 
       // seek beginning point definition in ply file
-      while(iort::Line<std::string>(pointsStream).compare("end_header") != 0);
+      while(iort::Line<std::string>(pointsInput).compare("end_header") != 0);
 
+      iort::Tokens pointTokens(" \t");
+      iort::Tokens textures(" \t");
       for (unsigned int pointId = 0; pointId < numPoints; ++pointId)
       {
-        iort::Tokens pointTokens(iort::Line(pointsStream, " \t"));
+        iort::Line(pointsInput, &pointTokens);
 
-        pInputAdapter->OnBeginPoint();
         const FloatType pointPosX = iort::Token<FloatType>(pointTokens);
         const FloatType pointPosY = iort::Token<FloatType>(pointTokens);
         const FloatType pointPosZ = iort::Token<FloatType>(pointTokens);
-        pInputAdapter->OnPointPosition(pointPosX, pointPosY, pointPosZ);
+        batch.AddPosition(pointPosX, pointPosY, pointPosZ);
 
         iort::Token<iort::Unused>(pointTokens); // nx
         iort::Token<iort::Unused>(pointTokens); // ny
@@ -160,38 +179,41 @@ DenseReader::Load
         const FloatType pointColR =
           iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
         const FloatType pointColG =
-          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);;
+          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
         const FloatType pointColB =
-          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);;
-        pInputAdapter->OnPointColour(pointColR, pointColG, pointColB);
+          iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+        batch.AddColour(pointColR, pointColG, pointColB);
 
         // seek next patch in patch file
-        while(iort::Line<std::string>(patchesStream).compare("PATCHS") != 0);
+        while(iort::Line<std::string>(patchesFile).compare("PATCHS") != 0);
 
-        iort::Line<iort::Unused>(patchesStream); // position
-        iort::Line<iort::Unused>(patchesStream); // normal
-        iort::Line<iort::Unused>(patchesStream); // confidence and debug
+        iort::Line<iort::Unused>(patchesFile); // position
+        iort::Line<iort::Unused>(patchesFile); // normal
+        iort::Line<iort::Unused>(patchesFile); // confidence and debug
 
-        const unsigned int numCoords = iort::Line<unsigned int>(patchesStream);
-        iort::Tokens textures(iort::Line(patchesStream, " \t"));
+        const unsigned int numCoords = iort::Line<unsigned int>(patchesFile);
+        iort::Line(patchesFile, &textures);
         for (unsigned int texCoord = 0u; texCoord < numCoords; ++texCoord)
         {
           const unsigned int textureId = iort::Token<unsigned int>(textures);
 
-          pInputAdapter->OnPointTexCoord(textureId, 0.0f, 0.0f);
+          batch.AddTexCoord(textureId, 0.0f, 0.0f);
         } // for all tex coords per point
-        pInputAdapter->OnEndPoint();
+        batch.EndPoint();
+
+        if (batch.GetSize() == io::kPointBatchSize)
+        {
+          pInputAdapter->OnPointBatch(batch);
+          batch.Clear();
+        }
       } // for all points
-      if (patchesStream.is_open())
-      {
-        patchesStream.close();
-      }
-      if (pointsStream.is_open())
-      {
-        pointsStream.close();
-      }
     } // if .patch file
   } // for all .patch files
+
+  if (!batch.IsEmpty())
+  {
+    pInputAdapter->OnPointBatch(batch);
+  }
 }
 
 
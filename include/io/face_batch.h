@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__FACE_BATCH_H_
+#define AVIGLE__IO__FACE_BATCH_H_
+
+
+#include <cstddef>
+
+#include <vector>
+
+
+namespace io
+{
+
+/// Number of faces readers collect before handing them to an adapter.
+const std::size_t kFaceBatchSize = 4096u;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// A run of mesh faces. The vertex indices of face i are the entries
+/// [fOffsets[i], fOffsets[i + 1]) of fIndices. Indices refer to the points
+/// in the order the reader delivered them, counting from 0.
+////////////////////////////////////////////////////////////////////////////////
+struct FaceBatch
+{
+  std::vector<unsigned int> fIndices;
+  std::vector<unsigned int> fOffsets;
+
+  FaceBatch()
+  : fOffsets(1u, 0u)
+  {}
+
+  std::size_t GetSize() const { return this->fOffsets.size() - 1u; }
+  bool IsEmpty() const { return (this->GetSize() == 0u); }
+
+  void Clear()
+  {
+    this->fIndices.clear();
+    this->fOffsets.resize(1u);
+  }
+
+  void AddIndex(unsigned int index)
+  {
+    this->fIndices.push_back(index);
+  }
+
+  /// Closes the face whose indices were added last.
+  void EndFace()
+  {
+    this->fOffsets.push_back(static_cast<unsigned int>(this->fIndices.size()));
+  }
+
+  /// Drops indices added after the last complete face.
+  void DropOpenFace()
+  {
+    this->fIndices.resize(this->fOffsets.back());
+  }
+};  // struct
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__FACE_BATCH_H_
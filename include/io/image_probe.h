@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__IMAGE_PROBE_H_
+#define AVIGLE__IO__IMAGE_PROBE_H_
+
+
+#include <ctime>
+#include <istream>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+#include <io/io_api.h>
+#include <io/load_options.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the sizes of images without decoding them.
+///
+/// Sizes are taken, in this order, from a list of known sizes (see
+/// ReadSizeList()), a default size for all images, the cache, or the image
+/// file itself. Only the first kHeaderBlockSize bytes of a JPEG file are
+/// read, further blocks only if the frame header follows large segments.
+/// If a cache file is given, sizes read from images are stored there,
+/// together with modification time and size of the image, and reused by
+/// later probes as long as the image is unchanged.
+////////////////////////////////////////////////////////////////////////////////
+class IO_API ImageProbe : private boost::noncopyable
+{
+public:
+  explicit ImageProbe(const std::string& cacheFileName = std::string(""));
+  explicit ImageProbe(const io::LoadOptions& loadOptions);
+  ~ImageProbe();
+
+  void SetDefaultSize(unsigned int width, unsigned int height);
+  void ReadSizeList(const std::string& fileName);
+
+  bool GetSize(const std::string& fileName,
+               unsigned int* pWidth,
+               unsigned int* pHeight);
+
+  bool GetSizes(const std::vector<std::string>& fileNames,
+                std::vector<unsigned int>* pWidths,
+                std::vector<unsigned int>* pHeights,
+                unsigned int numThreads = 1u);
+
+  bool Save();
+
+  static bool ReadJpegSize(const std::string& fileName,
+                           unsigned int* pWidth,
+                           unsigned int* pHeight);
+
+  static const std::size_t kHeaderBlockSize = 4096u;
+
+private:
+  typedef std::pair<unsigned int, unsigned int> Size;
+
+  /// Reads up to kHeaderBlockSize bytes from the given file offset into a
+  /// block and returns the number of bytes read, 0 on errors.
+  typedef boost::function<std::size_t (boost::uint64_t,
+                                       unsigned char*)> BlockReadFunction;
+
+  struct CacheEntry
+  {
+    std::time_t fModificationTime;
+    boost::uintmax_t fFileSize;
+    Size fSize;
+  };
+
+  void Load();
+  void ProbeTask(const std::string* pFileName,
+                 unsigned int* pWidth,
+                 unsigned int* pHeight);
+
+  static std::string Normalise(const std::string& fileName);
+
+  static bool FindJpegSize(const BlockReadFunction& readBlock,
+                           unsigned int* pWidth,
+                           unsigned int* pHeight);
+#ifndef WIN32
+  static std::size_t ReadFileBlock(int fileDescriptor,
+                                   boost::uint64_t offset,
+                                   unsigned char* pBlock);
+#endif
+  static std::size_t ReadStreamBlock(std::istream* pInput,
+                                     boost::uint64_t offset,
+                                     unsigned char* pBlock);
+
+  std::string fCacheFileName;
+  std::map<std::string, CacheEntry> fCache;
+  bool fIsCacheModified;
+  std::map<std::string, Size> fListedSizes;
+  Size fDefaultSize;
+  boost::mutex fMutex;
+};  // class
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__IMAGE_PROBE_H_
@@ -45,8 +45,13 @@
 #define AVIGLE__IO__INPUT_ADAPTER_INTERFACE_H_
 
 
+#include <cstddef>
+
 #include <string>
 
+#include <io/face_batch.h>
+#include <io/point_batch.h>
+
 
 namespace io
 {
@@ -66,6 +71,27 @@ public:
   virtual void OnPointTexCoord(unsigned int id, FloatType u, FloatType v) = 0;
   virtual void OnEndPoint() = 0;
 
+  /// Size hints. Readers that know how many textures or points follow call
+  /// these once before delivering them, so adapters can reserve memory up
+  /// front. The counts are exact, but adapters must not rely on the calls.
+  virtual void OnBeginTextures(std::size_t /*numTextures*/) {}
+  virtual void OnBeginPoints(std::size_t /*numPoints*/) {}
+
+  /// Receives a run of points at once. Readers deliver all points through
+  /// this method; the default hands them on one callback per attribute.
+  virtual void OnPointBatch(const io::PointBatch<FloatType>& batch);
+
+  /// If true, readers that parse on several threads may call OnPointBatch
+  /// from all of them at once whenever the point order does not matter.
+  virtual bool AcceptsConcurrentBatches() const { return false; }
+
+  /// Mesh faces, so far only read from PLY files. Readers announce the
+  /// number of faces, then deliver them in batches in file order, i.e.
+  /// after the points unless a file stores its faces first. Adapters that
+  /// only handle points ignore them.
+  virtual void OnBeginFaces(std::size_t /*numFaces*/) {}
+  virtual void OnFaceBatch(const io::FaceBatch& /*batch*/) {}
+
   virtual void OnTexture(
     unsigned int id,
     const std::string& fileName,
@@ -80,6 +106,51 @@ public:
 };  // class
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+InputAdapterInterface<FloatType>::OnPointBatch
+(const io::PointBatch<FloatType>& batch)
+{
+  const std::size_t numPoints = batch.GetSize();
+  const bool hasNormals = batch.HasNormals();
+  const bool hasColours = batch.HasColours();
+  for (std::size_t point = 0u; point < numPoints; ++point)
+  {
+    this->OnBeginPoint();
+    this->OnPointPosition(batch.fPositions[3u * point],
+                          batch.fPositions[3u * point + 1u],
+                          batch.fPositions[3u * point + 2u]);
+    if (hasNormals)
+    {
+      this->OnPointNormal(batch.fNormals[3u * point],
+                          batch.fNormals[3u * point + 1u],
+                          batch.fNormals[3u * point + 2u]);
+    }
+    if (hasColours)
+    {
+      this->OnPointColour(batch.fColours[3u * point],
+                          batch.fColours[3u * point + 1u],
+                          batch.fColours[3u * point + 2u]);
+    }
+    for (unsigned int texCoord = batch.fTexCoordOffsets[point];
+         texCoord < batch.fTexCoordOffsets[point + 1u];
+         ++texCoord)
+    {
+      this->OnPointTexCoord(batch.fTexCoordIds[texCoord],
+                            batch.fTexCoords[2u * texCoord],
+                            batch.fTexCoords[2u * texCoord + 1u]);
+    }
+    this->OnEndPoint();
+  }
+}
+
+
 } // namespace io
 
 
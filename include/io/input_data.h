@@ -50,11 +50,18 @@
 #include <string>
 
 #include <io/cmvs_reader.h>
+#include <io/dataset_info.h>
 #include <io/dense_reader.h>
 #include <io/io_api.h>
+#include <io/load_options.h>
+#include <io/mapped_dataset.h>
 #include <io/nvm_reader.h>
 #include <io/ply_reader.h>
+#include <io/point_cloud.h>
+#include <io/point_cloud_output_adapter.h>
 #include <io/rmv_reader.h>
+#include <io/rmv_stream_adapter.h>
+#include <io/rmv_writer.h>
 
 
 namespace io
@@ -86,13 +93,30 @@ public:
   template <typename FloatType>
   void Load(io::InputAdapterInterface<FloatType>* pInputAdapter);
 
+  io::DatasetInfo Probe() const;
+
+  bool Map(io::MappedDataset* pDataset) const;
+
+  template <typename FloatType>
+  void ExportMapped(const std::string& fileName);
+
+  template <typename FloatType>
+  void Convert(const std::string& fileName);
+
   bool IsValid() const { return (this->fFileType != kFileTypeInvalid); }
   const std::string& GetInfo() const { return this->fInfo; }
 
   const std::string& GetFileName() const { return this->fFileName; }
 
+  void SetLoadOptions(const io::LoadOptions& loadOptions)
+  {
+    this->fLoadOptions = loadOptions;
+  }
+  const io::LoadOptions& GetLoadOptions() const { return this->fLoadOptions; }
+
 private:
   FileType fFileType;
+  io::LoadOptions fLoadOptions;
 
   std::string fFileName;
   std::string fInfo;
@@ -112,17 +136,17 @@ InputData::Load
 {
   if (this->fFileType == kFileTypeRMV)
   {
-    RmvReader reader(this->fFileName);
+    RmvReader reader(this->fFileName, this->fLoadOptions);
     reader.Load(pInputAdapter);
   }
   else if (this->fFileType == kFileTypeNVM)
   {
-    NvmReader reader(this->fFileName);
+    NvmReader reader(this->fFileName, this->fLoadOptions);
     reader.Load(pInputAdapter);
   }
   else if (this->fFileType == kFileTypeCMVS)
   {
-    CmvsReader reader(this->fFileName);
+    CmvsReader reader(this->fFileName, this->fLoadOptions);
     reader.Load(pInputAdapter);
   }
   else if (this->fFileType == kFileTypePLY)
@@ -144,6 +168,54 @@ InputData::Load
 }
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Loads the data set and writes it as binary RMV file, which Map() can open
+/// without parsing.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+InputData::ExportMapped
+(const std::string& fileName)
+{
+  io::PointCloud<FloatType> pointCloud;
+  this->Load(&pointCloud);
+
+  io::PointCloudOutputAdapter<FloatType> outputAdapter(pointCloud);
+  RmvWriter writer(fileName, RmvWriter::kRmvVersion020);
+  writer.Write(&outputAdapter);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Converts the data set into an RMV file. Text RMV files are written while
+/// the data set is parsed, without holding it in memory (see
+/// io::RmvStreamAdapter). Binary ones (.rmvb) need all counts up front and
+/// are written via ExportMapped().
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+InputData::Convert
+(const std::string& fileName)
+{
+  if (boost::filesystem::path(fileName).extension().compare(
+        std::string(".rmvb")) == 0)
+  {
+    this->ExportMapped<FloatType>(fileName);
+    return;
+  }
+
+  io::RmvStreamAdapter<FloatType> streamAdapter(fileName);
+  this->Load(&streamAdapter);
+  streamAdapter.Finish();
+}
+
+
 } // namespace io
 
 
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__LOAD_OPTIONS_H_
+#define AVIGLE__IO__LOAD_OPTIONS_H_
+
+
+#include <string>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Settings that control how InputData loads a data set.
+////////////////////////////////////////////////////////////////////////////////
+struct LoadOptions
+{
+  /// Number of threads parsing points. 1 parses on the calling thread,
+  /// 0 uses one thread per hardware thread.
+  unsigned int fNumThreads;
+
+  /// If set, points are handed to the adapter in file order. Otherwise they
+  /// are handed over as soon as they are parsed. Data sets spread over
+  /// several files (CMVS) keep the order within a file only.
+  bool fPreserveOrder;
+
+  /// Size of all images in pixels, for data sets taken with a single camera.
+  /// If set, readers that need image sizes (NVM) do not open the images.
+  /// 0 x 0 lets them read the sizes from the image files.
+  unsigned int fImageWidth;
+  unsigned int fImageHeight;
+
+  /// Optional text file with one line "<image file> <width> <height>" per
+  /// image, file names relative to the list. Listed images are not opened;
+  /// it takes precedence over fImageWidth and fImageHeight.
+  std::string fImageSizesFileName;
+
+  /// Optional file caching the sizes read from images across loads (see
+  /// io::ImageProbe). Images that did not change are not opened again.
+  std::string fImageCacheFileName;
+
+  LoadOptions()
+  : fNumThreads(1u)
+  , fPreserveOrder(true)
+  , fImageWidth(0u)
+  , fImageHeight(0u)
+  , fImageSizesFileName()
+  , fImageCacheFileName()
+  {}
+};  // struct
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__LOAD_OPTIONS_H_
@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__MAPPED_DATASET_H_
+#define AVIGLE__IO__MAPPED_DATASET_H_
+
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <io/io_api.h>
+#include <io/mapped_file.h>
+#include <io/rmv_format.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read-only view of count values of type T.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+struct ConstSpan
+{
+  const T* fData;
+  std::size_t fSize;
+
+  ConstSpan()
+  : fData(NULL)
+  , fSize(0u)
+  {}
+
+  ConstSpan(const T* data, std::size_t size)
+  : fData(data)
+  , fSize(size)
+  {}
+
+  const T* begin() const { return this->fData; }
+  const T* end() const { return this->fData + this->fSize; }
+  std::size_t size() const { return this->fSize; }
+  bool empty() const { return (this->fSize == 0u); }
+  const T& operator[](std::size_t index) const { return this->fData[index]; }
+};  // struct
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Zero-copy access to a binary RMV file (see io::RmvFormat). Opening maps
+/// the file and checks its header; the columns are then used in place, no
+/// point is parsed or copied. Columns are aligned to 64 bytes. Offsets
+/// between the first and the last are only checked by Validate().
+///
+/// The scalar getters return an empty span unless FloatType matches the
+/// scalar type of the file. Files can only be opened on little-endian hosts.
+////////////////////////////////////////////////////////////////////////////////
+class IO_API MappedDataset : private boost::noncopyable
+{
+public:
+  MappedDataset();
+  ~MappedDataset();
+
+  bool Open(const std::string& fileName);
+  void Close();
+  bool IsOpen() const { return (this->fpFile != NULL); }
+  bool Validate() const;
+
+  std::size_t GetNumPoints() const { return this->fHeader.fNumPoints; }
+  std::size_t GetNumTexCoords() const { return this->fHeader.fNumTexCoords; }
+  io::RmvFormat::ScalarType GetScalarType() const
+  {
+    return static_cast<io::RmvFormat::ScalarType>(this->fHeader.fScalarType);
+  }
+  const double* GetBoundingBoxMin() const
+  {
+    return this->fHeader.fBoundingBoxMin;
+  }
+  const double* GetBoundingBoxMax() const
+  {
+    return this->fHeader.fBoundingBoxMax;
+  }
+
+  const std::vector<io::RmvFormat::TextureRecord>& GetTextures() const
+  {
+    return this->fTextures;
+  }
+
+  template <typename FloatType>
+  io::ConstSpan<FloatType> GetPositions() const
+  {
+    return this->GetScalars<FloatType>(this->fHeader.fPositionsOffset,
+                                       3u * this->GetNumPoints());
+  }
+  template <typename FloatType>
+  io::ConstSpan<FloatType> GetColours() const
+  {
+    return this->GetScalars<FloatType>(this->fHeader.fColoursOffset,
+                                       3u * this->GetNumPoints());
+  }
+  template <typename FloatType>
+  io::ConstSpan<FloatType> GetConfidences() const
+  {
+    return this->GetScalars<FloatType>(this->fHeader.fConfidencesOffset,
+                                       this->GetNumPoints());
+  }
+  io::ConstSpan<boost::uint64_t> GetTexCoordOffsets() const;
+  io::ConstSpan<boost::uint32_t> GetTexCoordIds() const;
+  template <typename FloatType>
+  io::ConstSpan<FloatType> GetTexCoords() const
+  {
+    return this->GetScalars<FloatType>(this->fHeader.fTexCoordsOffset,
+                                       2u * this->GetNumTexCoords());
+  }
+
+private:
+  template <typename FloatType>
+  io::ConstSpan<FloatType> GetScalars(boost::uint64_t offset,
+                                      std::size_t count) const
+  {
+    if (!this->IsOpen() || sizeof(FloatType) != this->fHeader.fScalarType)
+    {
+      return io::ConstSpan<FloatType>();
+    }
+    return io::ConstSpan<FloatType>(
+      reinterpret_cast<const FloatType*>(this->fpFile->GetBegin() + offset),
+      count);
+  }
+
+  boost::scoped_ptr<io::MappedFile> fpFile;
+  io::RmvFormat::Header fHeader;
+  std::vector<io::RmvFormat::TextureRecord> fTextures;
+};  // class
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__MAPPED_DATASET_H_
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__MAPPED_FILE_H_
+#define AVIGLE__IO__MAPPED_FILE_H_
+
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <io/io_api.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read-only view of a whole input file. Regular files are memory mapped and
+/// advised for sequential access, so readers parse the page cache in place.
+/// Anything that cannot be mapped (pipes, character devices, ...) is read
+/// into an internal buffer instead. A read position allows the readers to
+/// consume the file line by line (see io::ReaderTools).
+////////////////////////////////////////////////////////////////////////////////
+class IO_API MappedFile : private boost::noncopyable
+{
+public:
+  MappedFile(const std::string& fileName);
+  ~MappedFile();
+
+  bool IsOpen() const { return this->fIsOpen; }
+  bool IsMapped() const { return this->fIsMapped; }
+
+  const char* GetBegin() const { return this->fBegin; }
+  const char* GetEnd() const { return this->fBegin + this->fSize; }
+  std::size_t GetSize() const { return this->fSize; }
+
+  const char* GetPosition() const { return this->fPosition; }
+  void SetPosition(const char* position) { this->fPosition = position; }
+  bool IsAtEnd() const { return (this->fPosition == this->GetEnd()); }
+
+private:
+  bool Map(const std::string& fileName);
+  bool Read(const std::string& fileName);
+
+  const char* fBegin;
+  std::size_t fSize;
+  const char* fPosition;
+
+  bool fIsOpen;
+  bool fIsMapped;
+
+  std::vector<char> fBuffer;
+};  // class
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__MAPPED_FILE_H_
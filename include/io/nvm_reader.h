@@ -47,15 +47,20 @@
 
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <boost/filesystem.hpp>
-#include <boost/tokenizer.hpp>
 
 #include <io/input_adapter_interface.h>
+#include <io/dataset_info.h>
+#include <io/image_probe.h>
 #include <io/io_api.h>
+#include <io/load_options.h>
+#include <io/mapped_file.h>
+#include <io/parallel_tools.h>
+#include <io/point_batch.h>
 #include <io/reader_tools.h>
 
 
@@ -76,18 +81,31 @@ private:
     kNvmVersionInvalid
   };
 
-  NvmReader(const std::string& fileName);
+  NvmReader(const std::string& fileName,
+            const io::LoadOptions& loadOptions = io::LoadOptions());
   ~NvmReader();
 
+  void Probe(io::DatasetInfo* pInfo);
+
   template <typename FloatType>
   void Load(InputAdapterInterface<FloatType>* pInputAdapter);
 
-  static void GetJpegSize(const std::string& fileName,
-                          unsigned int* width,
-                          unsigned int* height);
+  template <typename FloatType>
+  static void ParsePoint(
+    io::ReaderTools::Tokens& pointTokens,
+    const std::vector<std::pair<FloatType, FloatType> >& textureCentres,
+    io::PointBatch<FloatType>* pBatch);
+
+  template <typename FloatType>
+  static void ParsePoints(
+    const char* begin,
+    const char* end,
+    const std::vector<std::pair<FloatType, FloatType> >* pTextureCentres,
+    io::PointBatch<FloatType>* pBatch);
 
   boost::filesystem::path fInputPath;
   NvmVersion fVersion;
+  io::LoadOptions fLoadOptions;
 };  // class
 
 
@@ -108,8 +126,8 @@ NvmReader::Load
   namespace iort = io::ReaderTools;
 
   // open
-  std::ifstream inputStream(this->fInputPath.c_str());
-  if (!inputStream.is_open())
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
   {
     std::cerr << "Could not open input file " << this->fInputPath << "!";
     std::cerr << std::endl;
@@ -118,7 +136,7 @@ NvmReader::Load
   }
 
   // determine version
-  const std::string version(iort::Line<std::string>(inputStream).substr(0, 6));
+  const std::string version(iort::Line<std::string>(inputFile).substr(0, 6));
   if(version.compare("NVM_V3") == 0)
   {
     this->fVersion = io::NvmReader::kNvmVersion030;
@@ -133,26 +151,55 @@ NvmReader::Load
 
 
   // TEXTURES
-  std::map<unsigned int, TextureCentre> textureCentres;
-  const unsigned int numOfTextures = iort::Line<unsigned int>(inputStream);
+  const unsigned int numOfTextures = iort::Line<unsigned int>(inputFile);
+  pInputAdapter->OnBeginTextures(numOfTextures);
+
+  // The principal points need the image sizes. Collect the file names first,
+  // so the sizes of all images are determined at once.
+  const char* const texturesBegin = inputFile.GetPosition();
+  std::vector<std::string> textureFileNames;
+  textureFileNames.reserve(numOfTextures);
+  iort::Tokens textureTokens(" \t");
+  for (unsigned int texNum = 0; texNum < numOfTextures; ++texNum)
+  {
+    iort::Line(inputFile, &textureTokens);
+    textureFileNames.push_back(
+      bf::absolute(bf::path(iort::Token<std::string>(textureTokens)),
+                   this->fInputPath.parent_path()).string());
+  }
+  std::vector<unsigned int> imageWidths;
+  std::vector<unsigned int> imageHeights;
+  io::ImageProbe imageProbe(this->fLoadOptions);
+  if (!imageProbe.GetSizes(textureFileNames, &imageWidths, &imageHeights,
+                           this->fLoadOptions.fNumThreads))
+  {
+    for (unsigned int texNum = 0; texNum < numOfTextures; ++texNum)
+    {
+      if (imageWidths[texNum] == 0u || imageHeights[texNum] == 0u)
+      {
+        std::cerr << "Error reading file " << textureFileNames[texNum] << "!";
+        std::cerr << std::endl;
+        break;
+      }
+    }
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  inputFile.SetPosition(texturesBegin);
+
+  // flat table of principal points, indexed by camera id
+  std::vector<TextureCentre> textureCentres;
+  textureCentres.reserve(numOfTextures);
   for (unsigned int texNum = 0; texNum < numOfTextures; ++texNum)
   {
-    iort::Tokens textureTokens(iort::Line(inputStream, " \t"));
-
-    const boost::filesystem::path textureFile(        // file name
-      boost::filesystem::absolute(
-        boost::filesystem::path(iort::Token<std::string>(textureTokens)),
-        this->fInputPath.parent_path()));
-
-    // compute and store image sizes
-    unsigned int jpegWidth = 0u;
-    unsigned int jpegHeight = 0u;
-    NvmReader::GetJpegSize(textureFile.string(), &jpegWidth, &jpegHeight);
-    textureCentres[texNum] =
+    iort::Line(inputFile, &textureTokens);
+    iort::Token<iort::Unused>(textureTokens);         // file name
+
+    textureCentres.push_back(
       TextureCentre(static_cast<FloatType>(0.5) *
-                      static_cast<FloatType>(jpegWidth),
+                      static_cast<FloatType>(imageWidths[texNum]),
                     static_cast<FloatType>(0.5) *
-                      static_cast<FloatType>(jpegHeight));
+                      static_cast<FloatType>(imageHeights[texNum])));
 
     const FloatType focal = iort::Token<FloatType>(textureTokens); // foc.len.
 
@@ -212,9 +259,9 @@ NvmReader::Load
 
     pInputAdapter->OnTexture(
       texNum,                                         // id
-      textureFile.string(),
-      0u,                                             // width
-      0u,                                             // height
+      textureFileNames[texNum],
+      imageWidths[texNum],                            // width
+      imageHeights[texNum],                           // height
       posX,                                           // cam pos
       posY,
       posZ,
@@ -231,43 +278,135 @@ NvmReader::Load
   }
 
   // POINTS
-  const unsigned int numOfPoints = iort::Line<unsigned int>(inputStream);
-  for (unsigned int pointNum = 0; pointNum < numOfPoints; ++pointNum)
+  const unsigned int numOfPoints = iort::Line<unsigned int>(inputFile);
+  pInputAdapter->OnBeginPoints(numOfPoints);
+  if (this->fLoadOptions.fNumThreads != 1u)
   {
-    iort::Tokens pointTokens(iort::Line(inputStream, " \t"));
-
-    pInputAdapter->OnBeginPoint();
-    const FloatType x = iort::Token<FloatType>(pointTokens);
-    const FloatType y = iort::Token<FloatType>(pointTokens);
-    const FloatType z = iort::Token<FloatType>(pointTokens);
-    const FloatType r =
-      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
-    const FloatType g =
-      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
-    const FloatType b =
-      iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
-
-    pInputAdapter->OnPointPosition(x, y, z);
-    pInputAdapter->OnPointColour(r, g, b);
-
-    // tex coords per point
-    const unsigned int numCoords = iort::Token<unsigned int>(pointTokens);
-    for (unsigned int texCoord = 0; texCoord < numCoords; ++texCoord)
+    // the point block is followed by further models, so find its end first
+    const char* const pointsBegin = inputFile.GetPosition();
+    const char* pointsEnd = pointsBegin;
+    const char* lineBegin = NULL;
+    const char* lineEnd = NULL;
+    for (unsigned int pointNum = 0; pointNum < numOfPoints; ++pointNum)
+    {
+      iort::NonCommentLine(&pointsEnd, inputFile.GetEnd(),
+                           &lineBegin, &lineEnd);
+    }
+    inputFile.SetPosition(pointsEnd);
+
+    io::ParallelChunkParser<FloatType> parser(
+      boost::bind(&io::NvmReader::ParsePoints<FloatType>,
+                  _1, _2, &textureCentres, _3),
+      this->fLoadOptions.fNumThreads,
+      this->fLoadOptions.fPreserveOrder);
+    const std::size_t numOfLoadedPoints = parser.Run(
+      io::ParallelTools::SplitLines(pointsBegin, pointsEnd),
+      numOfPoints,
+      pInputAdapter);
+    if (numOfLoadedPoints != numOfPoints)
     {
-      const unsigned int id = iort::Token<unsigned int>(pointTokens);
-      iort::Token<iort::Unused>(pointTokens); // feature index --> not yet used
-      const FloatType u =
-        iort::Token<FloatType>(pointTokens) + textureCentres[id].first;
-      const FloatType v =
-        iort::Token<FloatType>(pointTokens) + textureCentres[id].second;
-      pInputAdapter->OnPointTexCoord(id, u, v);
+      std::cerr << "Input file " << this->fInputPath << " is truncated!";
+      std::cerr << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
     }
-    pInputAdapter->OnEndPoint();
   }
+  else
+  {
+    iort::Tokens pointTokens(" \t");
+    io::PointBatch<FloatType> batch;
+    for (unsigned int pointNum = 0; pointNum < numOfPoints; ++pointNum)
+    {
+      iort::Line(inputFile, &pointTokens);
+      NvmReader::ParsePoint(pointTokens, textureCentres, &batch);
+      if (batch.GetSize() == io::kPointBatchSize)
+      {
+        pInputAdapter->OnPointBatch(batch);
+        batch.Clear();
+      }
+    }
+    if (!batch.IsEmpty())
+    {
+      pInputAdapter->OnPointBatch(batch);
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses one line of the point block. The measurements are shifted by the
+/// principal point of their camera.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+NvmReader::ParsePoint
+(io::ReaderTools::Tokens& pointTokens,
+ const std::vector<std::pair<FloatType, FloatType> >& textureCentres,
+ io::PointBatch<FloatType>* pBatch)
+{
+  namespace iort = io::ReaderTools;
+
+  const FloatType x = iort::Token<FloatType>(pointTokens);
+  const FloatType y = iort::Token<FloatType>(pointTokens);
+  const FloatType z = iort::Token<FloatType>(pointTokens);
+  const FloatType r =
+    iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+  const FloatType g =
+    iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+  const FloatType b =
+    iort::Token<FloatType>(pointTokens) / static_cast<FloatType>(255.0);
+
+  pBatch->AddPosition(x, y, z);
+  pBatch->AddColour(r, g, b);
+
+  // tex coords per point
+  const std::size_t numOfTextures = textureCentres.size();
+  const unsigned int numCoords = iort::Token<unsigned int>(pointTokens);
+  for (unsigned int texCoord = 0; texCoord < numCoords; ++texCoord)
+  {
+    const unsigned int id = iort::Token<unsigned int>(pointTokens);
+    iort::Token<iort::Unused>(pointTokens); // feature index --> not yet used
+    FloatType u = iort::Token<FloatType>(pointTokens);
+    FloatType v = iort::Token<FloatType>(pointTokens);
+    if (id < numOfTextures)
+    {
+      u += textureCentres[id].first;
+      v += textureCentres[id].second;
+    }
+    pBatch->AddTexCoord(id, u, v);
+  }
+  pBatch->EndPoint();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses all point lines in [begin, end), used for chunks of the point block
+/// when parsing in parallel.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+NvmReader::ParsePoints
+(const char* begin,
+ const char* end,
+ const std::vector<std::pair<FloatType, FloatType> >* pTextureCentres,
+ io::PointBatch<FloatType>* pBatch)
+{
+  namespace iort = io::ReaderTools;
 
-  if (inputStream.is_open())
+  iort::Tokens pointTokens(" \t");
+  const char* position = begin;
+  const char* lineBegin = NULL;
+  const char* lineEnd = NULL;
+  while (iort::NonCommentLine(&position, end, &lineBegin, &lineEnd))
   {
-    inputStream.close();
+    pointTokens.Assign(lineBegin, lineEnd);
+    NvmReader::ParsePoint(pointTokens, *pTextureCentres, pBatch);
   }
 }
 
@@ -45,8 +45,13 @@
 #define SURFACE_RECONSTRUCTION__OUTPUT_ADAPTER_INTERFACE_H_
 
 
+#include <cstdlib>
+
+#include <iostream>
 #include <string>
 
+#include <io/point_batch.h>
+
 
 namespace io
 {
@@ -81,9 +86,131 @@ public:
   virtual void GetPointTextureCoordinate(unsigned int *imId,
                                          FloatType *u,
                                          FloatType *v) = 0;
+
+  /// Replaces the contents of pBatch by the next numPoints points, which
+  /// must not exceed the number of points left (see CountPoints()). The
+  /// batch holds positions, colours and confidences of every point. This
+  /// advances the same cursor as FetchNextPoint(); the default is built on
+  /// the per point calls.
+  virtual void FetchPointBatch(io::PointBatch<FloatType> *pBatch,
+                               unsigned int numPoints);
+
+  // Optional random access to the points. Adapters returning true from
+  // SupportsRandomAccess() must answer GetPoint() and GetPointTexCoords()
+  // for any index, from several threads at once, without touching the
+  // cursor above. Writers then format ranges of points concurrently. The
+  // defaults terminate, as they must not be called for other adapters.
+  virtual bool SupportsRandomAccess() const { return false; }
+  virtual void GetPoint(unsigned int index,
+                        FloatType *position,
+                        FloatType *colour,
+                        FloatType *conf) const;
+  virtual unsigned int GetPointTexCoords(unsigned int index,
+                                         const unsigned int **imIds,
+                                         const FloatType **texCoords) const;
+
+private:
+  void TerminateWithoutRandomAccess() const;
 };  // class
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+OutputAdapterInterface<FloatType>::FetchPointBatch
+(io::PointBatch<FloatType> *pBatch, unsigned int numPoints)
+{
+  pBatch->Clear();
+  for (unsigned int point = 0u; point < numPoints; ++point)
+  {
+    this->FetchNextPoint();
+
+    FloatType x, y, z;
+    this->GetPointPosition(&x, &y, &z);
+    pBatch->AddPosition(x, y, z);
+
+    FloatType r, g, b;
+    this->GetPointColour(&r, &g, &b);
+    pBatch->AddColour(r, g, b);
+
+    FloatType conf;
+    this->GetPointConfidence(&conf);
+    pBatch->AddConfidence(conf);
+
+    const unsigned int numTexCoords = this->CountPointTextureCoordinates();
+    for (unsigned int texCoord = 0u; texCoord < numTexCoords; ++texCoord)
+    {
+      this->FetchNextPointTextureCoordinate();
+
+      unsigned int id;
+      FloatType u, v;
+      this->GetPointTextureCoordinate(&id, &u, &v);
+      pBatch->AddTexCoord(id, u, v);
+    }
+    pBatch->EndPoint();
+  }
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+OutputAdapterInterface<FloatType>::GetPoint
+(unsigned int /*index*/,
+ FloatType* /*position*/,
+ FloatType* /*colour*/,
+ FloatType* /*conf*/) const
+{
+  this->TerminateWithoutRandomAccess();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+unsigned int
+OutputAdapterInterface<FloatType>::GetPointTexCoords
+(unsigned int /*index*/,
+ const unsigned int** /*imIds*/,
+ const FloatType** /*texCoords*/) const
+{
+  this->TerminateWithoutRandomAccess();
+  return 0u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+OutputAdapterInterface<FloatType>::TerminateWithoutRandomAccess
+() const
+{
+  std::cerr << "Output adapter does not support random access!" << std::endl;
+  std::cerr << "Terminating." << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+
 } // namespace io
 
 
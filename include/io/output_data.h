@@ -68,6 +68,7 @@ public:
   enum FileType
   {
     kFileTypeRMV = 0,
+    kFileTypeRMVB,
     kFileTypeInvalid
   };
 
@@ -80,8 +81,17 @@ public:
   bool IsValid() const { return (this->fFileType != kFileTypeInvalid); }
   const std::string& GetInfo() const { return this->fInfo; }
 
+  /// Threads used for formatting text output, 0 (the default) meaning one
+  /// per hardware thread.
+  void SetNumThreads(unsigned int numThreads)
+  {
+    this->fNumThreads = numThreads;
+  }
+  unsigned int GetNumThreads() const { return this->fNumThreads; }
+
 private:
   FileType fFileType;
+  unsigned int fNumThreads;
 
   std::string fFileName;
   std::string fInfo;
@@ -103,7 +113,13 @@ io::OutputData::Write
 {
   if (this->fFileType == kFileTypeRMV)
   {
-    RmvWriter writer(this->fFileName);
+    RmvWriter writer(this->fFileName, RmvWriter::kRmvVersion010,
+                     this->fNumThreads);
+    writer.Write(pOutputAdapter);
+  }
+  else if (this->fFileType == kFileTypeRMVB)
+  {
+    RmvWriter writer(this->fFileName, RmvWriter::kRmvVersion020);
     writer.Write(pOutputAdapter);
   }
   else
@@ -0,0 +1,602 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__PARALLEL_TOOLS_H_
+#define AVIGLE__IO__PARALLEL_TOOLS_H_
+
+
+#include <algorithm>
+#include <cstddef>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+#include <io/input_adapter_interface.h>
+#include <io/io_api.h>
+#include <io/point_batch.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+namespace ParallelTools
+{
+
+typedef std::pair<const char*, const char*> ByteRange;
+
+/// Approximate number of bytes of text parsed as one unit of work.
+const std::size_t kChunkSize = 4u << 20;
+
+IO_API unsigned int GetNumThreads(unsigned int requested);
+
+IO_API std::vector<io::ParallelTools::ByteRange> SplitLines(
+  const char* begin,
+  const char* end,
+  std::size_t chunkSize = io::ParallelTools::kChunkSize);
+
+IO_API void Prefetch(const char* begin, const char* end);
+
+} // namespace ParallelTools
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses chunks of text in a three-stage pipeline. A read thread pulls the
+/// chunks into memory ahead of the parsers (see ParallelTools::Prefetch), so
+/// they do not wait for the disk. A number of worker threads parse them, and
+/// the resulting point batches are handed to an adapter on the calling
+/// thread, either in chunk order or in the order they are finished. Only a
+/// bounded number of chunks are read and parsed ahead of delivery, which
+/// bounds the memory in use. If the order does not matter and the adapter
+/// accepts concurrent batches, the workers hand their batches over
+/// themselves.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+class ParallelChunkParser : private boost::noncopyable
+{
+public:
+  typedef boost::function<void (const char*,
+                                const char*,
+                                io::PointBatch<FloatType>*)> ParseFunction;
+
+  ParallelChunkParser(const ParseFunction& parseFunction,
+                      unsigned int numThreads,
+                      bool preserveOrder);
+
+  std::size_t Run(const std::vector<io::ParallelTools::ByteRange>& chunks,
+                  std::size_t maxPoints,
+                  io::InputAdapterInterface<FloatType>* pInputAdapter);
+
+private:
+  void Read();
+  void Work();
+  void DeliverDirectly(io::PointBatch<FloatType>* pBatch);
+  void Deliver(const io::PointBatch<FloatType>& batch);
+  void Abort();
+
+  ParseFunction fParseFunction;
+  unsigned int fNumThreads;
+  bool fPreserveOrder;
+  std::size_t fMaxInFlight;
+  bool fIsDirect;
+
+  io::InputAdapterInterface<FloatType>* fpInputAdapter;
+  std::size_t fMaxPoints;
+  std::size_t fNumPoints;
+  const std::vector<io::ParallelTools::ByteRange>* fpChunks;
+  std::vector<io::PointBatch<FloatType> > fBatches;
+  std::vector<bool> fIsParsed;
+  std::deque<std::size_t> fParsedChunks;
+  std::size_t fNumRead;
+  std::size_t fNextChunk;
+  std::size_t fNumDelivered;
+  bool fIsAborted;
+  boost::exception_ptr fError;
+
+  boost::mutex fMutex;
+  boost::condition_variable fChunkRead;
+  boost::condition_variable fChunkParsed;
+  boost::condition_variable fChunkDelivered;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+ParallelChunkParser<FloatType>::ParallelChunkParser
+(const ParseFunction& parseFunction,
+ unsigned int numThreads,
+ bool preserveOrder)
+: fParseFunction(parseFunction)
+, fNumThreads(io::ParallelTools::GetNumThreads(numThreads))
+, fPreserveOrder(preserveOrder)
+, fMaxInFlight(4u * this->fNumThreads)
+, fIsDirect(false)
+, fpInputAdapter(NULL)
+, fMaxPoints(0u)
+, fNumPoints(0u)
+, fpChunks(NULL)
+, fNumRead(0u)
+, fNextChunk(0u)
+, fNumDelivered(0u)
+, fIsAborted(false)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses all chunks and delivers at most maxPoints points. Returns the
+/// number of points delivered. Exceptions thrown while parsing are rethrown
+/// on the calling thread.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+std::size_t
+ParallelChunkParser<FloatType>::Run
+(const std::vector<io::ParallelTools::ByteRange>& chunks,
+ std::size_t maxPoints,
+ io::InputAdapterInterface<FloatType>* pInputAdapter)
+{
+  const std::size_t numChunks = chunks.size();
+  this->fIsDirect =
+    !this->fPreserveOrder && pInputAdapter->AcceptsConcurrentBatches();
+  this->fpInputAdapter = pInputAdapter;
+  this->fMaxPoints = maxPoints;
+  this->fNumPoints = 0u;
+  this->fpChunks = &chunks;
+  this->fBatches.assign(numChunks, io::PointBatch<FloatType>());
+  this->fIsParsed.assign(numChunks, false);
+  this->fParsedChunks.clear();
+  this->fNumRead = 0u;
+  this->fNextChunk = 0u;
+  this->fNumDelivered = 0u;
+  this->fIsAborted = false;
+  this->fError = boost::exception_ptr();
+
+  boost::thread_group workers;
+  workers.create_thread(
+    boost::bind(&io::ParallelChunkParser<FloatType>::Read, this));
+  for (unsigned int thread = 0u; thread < this->fNumThreads; ++thread)
+  {
+    workers.create_thread(
+      boost::bind(&io::ParallelChunkParser<FloatType>::Work, this));
+  }
+
+  if (this->fIsDirect)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(this->fMutex);
+      while (!this->fError && this->fNumDelivered < numChunks)
+      {
+        this->fChunkDelivered.wait(lock);
+      }
+    }
+    this->Abort();
+    workers.join_all();
+    if (this->fError)
+    {
+      boost::rethrow_exception(this->fError);
+    }
+    return this->fNumPoints;
+  }
+
+  std::size_t numPoints = 0u;
+  try
+  {
+    for (std::size_t delivery = 0u; delivery < numChunks; ++delivery)
+    {
+      std::size_t chunk = delivery;
+      {
+        boost::unique_lock<boost::mutex> lock(this->fMutex);
+        while (!this->fError &&
+               (this->fPreserveOrder ? !this->fIsParsed[delivery]
+                                     : this->fParsedChunks.empty()))
+        {
+          this->fChunkParsed.wait(lock);
+        }
+        if (this->fError)
+        {
+          break;
+        }
+        if (!this->fPreserveOrder)
+        {
+          chunk = this->fParsedChunks.front();
+          this->fParsedChunks.pop_front();
+        }
+      }
+
+      io::PointBatch<FloatType>& batch = this->fBatches[chunk];
+      batch.Truncate(maxPoints - numPoints);
+      numPoints += batch.GetSize();
+      this->Deliver(batch);
+      io::PointBatch<FloatType>().Swap(batch);
+
+      {
+        boost::lock_guard<boost::mutex> lock(this->fMutex);
+        ++this->fNumDelivered;
+      }
+      this->fChunkDelivered.notify_all();
+    }
+  }
+  catch (...)
+  {
+    this->Abort();
+    workers.join_all();
+    throw;
+  }
+
+  this->Abort();
+  workers.join_all();
+  if (this->fError)
+  {
+    boost::rethrow_exception(this->fError);
+  }
+  return numPoints;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Body of the read thread. Stays within the same window of chunks as the
+/// parsers.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ParallelChunkParser<FloatType>::Read
+()
+{
+  const std::size_t numChunks = this->fpChunks->size();
+  for (std::size_t chunk = 0u; chunk < numChunks; ++chunk)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(this->fMutex);
+      while (!this->fIsAborted &&
+             chunk >= this->fNumDelivered + this->fMaxInFlight)
+      {
+        this->fChunkDelivered.wait(lock);
+      }
+      if (this->fIsAborted)
+      {
+        return;
+      }
+    }
+
+    io::ParallelTools::Prefetch((*this->fpChunks)[chunk].first,
+                                (*this->fpChunks)[chunk].second);
+
+    {
+      boost::lock_guard<boost::mutex> lock(this->fMutex);
+      this->fNumRead = chunk + 1u;
+    }
+    this->fChunkRead.notify_all();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ParallelChunkParser<FloatType>::Work
+()
+{
+  const std::size_t numChunks = this->fpChunks->size();
+  for (;;)
+  {
+    std::size_t chunk = 0u;
+    {
+      boost::unique_lock<boost::mutex> lock(this->fMutex);
+      while (!this->fIsAborted &&
+             this->fNextChunk < numChunks &&
+             this->fNextChunk >= this->fNumDelivered + this->fMaxInFlight)
+      {
+        this->fChunkDelivered.wait(lock);
+      }
+      if (this->fIsAborted || this->fNextChunk >= numChunks)
+      {
+        return;
+      }
+      chunk = this->fNextChunk++;
+
+      while (!this->fIsAborted && chunk >= this->fNumRead)
+      {
+        this->fChunkRead.wait(lock);
+      }
+      if (this->fIsAborted)
+      {
+        return;
+      }
+    }
+
+    try
+    {
+      this->fParseFunction((*this->fpChunks)[chunk].first,
+                           (*this->fpChunks)[chunk].second,
+                           &this->fBatches[chunk]);
+      if (this->fIsDirect)
+      {
+        this->DeliverDirectly(&this->fBatches[chunk]);
+      }
+    }
+    catch (...)
+    {
+      {
+        boost::lock_guard<boost::mutex> lock(this->fMutex);
+        if (!this->fError)
+        {
+          this->fError = boost::current_exception();
+        }
+        this->fIsAborted = true;
+      }
+      this->fChunkRead.notify_all();
+      this->fChunkParsed.notify_all();
+      this->fChunkDelivered.notify_all();
+      return;
+    }
+
+    if (this->fIsDirect)
+    {
+      {
+        boost::lock_guard<boost::mutex> lock(this->fMutex);
+        ++this->fNumDelivered;
+      }
+      this->fChunkDelivered.notify_all();
+      continue;
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(this->fMutex);
+      this->fIsParsed[chunk] = true;
+      this->fParsedChunks.push_back(chunk);
+    }
+    this->fChunkParsed.notify_one();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands a batch to the adapter from a worker thread, keeping the total
+/// number of points within the limit.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ParallelChunkParser<FloatType>::DeliverDirectly
+(io::PointBatch<FloatType>* pBatch)
+{
+  std::size_t numPoints = 0u;
+  {
+    boost::lock_guard<boost::mutex> lock(this->fMutex);
+    numPoints = std::min(pBatch->GetSize(),
+                         this->fMaxPoints - this->fNumPoints);
+    this->fNumPoints += numPoints;
+  }
+  pBatch->Truncate(numPoints);
+  this->Deliver(*pBatch);
+  io::PointBatch<FloatType>().Swap(*pBatch);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the points of a chunk to the adapter in batches of at most
+/// kPointBatchSize points, as the other readers do.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ParallelChunkParser<FloatType>::Deliver
+(const io::PointBatch<FloatType>& batch)
+{
+  const std::size_t numPoints = batch.GetSize();
+  if (numPoints <= io::kPointBatchSize)
+  {
+    if (numPoints > 0u)
+    {
+      this->fpInputAdapter->OnPointBatch(batch);
+    }
+    return;
+  }
+
+  io::PointBatch<FloatType> slice;
+  for (std::size_t first = 0u; first < numPoints;
+       first += io::kPointBatchSize)
+  {
+    const std::size_t last =
+      std::min(first + io::kPointBatchSize, numPoints);
+    slice.AssignRange(batch, first, last);
+    this->fpInputAdapter->OnPointBatch(slice);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ParallelChunkParser<FloatType>::Abort
+()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(this->fMutex);
+    this->fIsAborted = true;
+  }
+  this->fChunkRead.notify_all();
+  this->fChunkDelivered.notify_all();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// One point batch per thread. Threads fill their own batch without locking;
+/// full batches are handed to the adapter one at a time under a lock, unless
+/// the adapter accepts concurrent batches.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+class ThreadBatchBuffers : private boost::noncopyable
+{
+public:
+  ThreadBatchBuffers(unsigned int numThreads,
+                     io::InputAdapterInterface<FloatType>* pInputAdapter)
+  : fBatches(numThreads)
+  , fpInputAdapter(pInputAdapter)
+  {}
+
+  io::PointBatch<FloatType>& GetBatch(unsigned int thread)
+  {
+    return this->fBatches[thread];
+  }
+
+  void FlushIfFull(unsigned int thread);
+  void FlushAll();
+
+private:
+  void Flush(io::PointBatch<FloatType>* pBatch);
+
+  std::vector<io::PointBatch<FloatType> > fBatches;
+  io::InputAdapterInterface<FloatType>* fpInputAdapter;
+  boost::mutex fAdapterMutex;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ThreadBatchBuffers<FloatType>::FlushIfFull
+(unsigned int thread)
+{
+  if (this->fBatches[thread].GetSize() >= io::kPointBatchSize)
+  {
+    this->Flush(&this->fBatches[thread]);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the remaining points of all threads to the adapter. Must not be
+/// called while threads are still filling their batches.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ThreadBatchBuffers<FloatType>::FlushAll
+()
+{
+  for (std::size_t thread = 0u; thread < this->fBatches.size(); ++thread)
+  {
+    if (!this->fBatches[thread].IsEmpty())
+    {
+      this->Flush(&this->fBatches[thread]);
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+ThreadBatchBuffers<FloatType>::Flush
+(io::PointBatch<FloatType>* pBatch)
+{
+  if (this->fpInputAdapter->AcceptsConcurrentBatches())
+  {
+    this->fpInputAdapter->OnPointBatch(*pBatch);
+  }
+  else
+  {
+    boost::lock_guard<boost::mutex> lock(this->fAdapterMutex);
+    this->fpInputAdapter->OnPointBatch(*pBatch);
+  }
+  pBatch->Clear();
+}
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__PARALLEL_TOOLS_H_
@@ -45,19 +45,30 @@
 #define AVIGLE__IO__PLY_READER_H_
 
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <tr1/functional>
 #include <tr1/tuple>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/function.hpp>
+#include <boost/mpl/if.hpp>
 #include <boost/tokenizer.hpp>
 
+#include <io/byte_order.h>
+#include <io/dataset_info.h>
+#include <io/face_batch.h>
 #include <io/io_api.h>
 #include <io/input_adapter_interface.h>
+#include <io/mapped_file.h>
+#include <io/point_batch.h>
 #include <io/reader_tools.h>
 
 
@@ -77,9 +88,160 @@ private:
 
   void ParseFile();
 
+  void Probe(io::DatasetInfo* pInfo);
+
   template <typename FloatType>
   void Load(InputAdapterInterface<FloatType>* pInputAdapter);
 
+  /// Where the vertex attributes lie within the vertices of a PLY file:
+  /// byte offsets within the fixed-size records of binary files, field
+  /// indices within the lines of ASCII files. Slots are x, y, z, nx, ny, nz,
+  /// red, green, blue, each of any PLY scalar type; other properties are
+  /// skipped. Integer colours are scaled to [0, 1] by the maximum of their
+  /// type, floating point colours are taken as they are.
+  struct VertexLayout
+  {
+    enum Format
+    {
+      kFormatAscii = 0,
+      kFormatBinaryLittleEndian,
+      kFormatBinaryBigEndian
+    };
+
+    enum ScalarType
+    {
+      kScalarTypeNone = 0,
+      kScalarTypeInt8,
+      kScalarTypeInt16,
+      kScalarTypeInt32,
+      kScalarTypeUint8,
+      kScalarTypeUint16,
+      kScalarTypeUint32,
+      kScalarTypeFloat32,
+      kScalarTypeFloat64
+    };
+
+    static const unsigned int kNumSlots = 9u;
+
+    /// Slot size in the records the generic parser fills, fits any scalar.
+    static const std::size_t kMaxScalarSize = 8u;
+
+    Format fFormat;
+    bool fIsSwapped;  ///< binary scalars not in the host's byte order
+    std::size_t fNumVertices;
+    std::size_t fNumProperties;
+    std::size_t fRecordSize;
+    std::size_t fVerticesOffset;
+    std::size_t fVerticesLine;
+    ScalarType fTypes[kNumSlots];
+    std::size_t fOffsets[kNumSlots];
+  };
+
+  /// Where the faces lie: behind the vertices and the elements between them,
+  /// one list of vertex indices per face. Binary faces start at
+  /// fFacesOffset, ASCII ones fSkippedLines lines behind the vertices.
+  struct FaceLayout
+  {
+    std::size_t fNumFaces;
+    std::size_t fFacesOffset;
+    std::size_t fSkippedLines;
+    std::size_t fFacesLine;
+    bool fIsSwapped;
+    VertexLayout::ScalarType fCountType;
+    VertexLayout::ScalarType fIndexType;
+  };
+
+  static bool ReadLayout(io::MappedFile& inputFile,
+                         VertexLayout* pVertexLayout,
+                         FaceLayout* pFaceLayout);
+
+  static VertexLayout::ScalarType GetScalarType(const std::string& typeName);
+
+  template <typename ScalarType>
+  static VertexLayout::ScalarType GetScalarType();
+
+  template <typename FloatType>
+  bool LoadVertices(InputAdapterInterface<FloatType>* pInputAdapter);
+
+  template <typename FloatType>
+  static void FillColourTable(FloatType* pColourTable);
+
+  template <typename FloatType, typename ScalarType>
+  static FloatType ConvertScalar(ScalarType value, bool isColour);
+
+  template <typename FloatType>
+  static void DecodeVertices(const char* pRecords,
+                             std::size_t numVertices,
+                             const VertexLayout& layout,
+                             const FloatType* pColourTable,
+                             io::PointBatch<FloatType>* pBatch);
+
+  template <typename FloatType, typename ScalarType>
+  static void DecodeAttribute(const char* pSource,
+                              std::size_t recordSize,
+                              std::size_t numVertices,
+                              bool isColour,
+                              bool isSwapped,
+                              FloatType* pTarget);
+
+  template <typename FloatType>
+  static bool ScanVertices(const char** pPosition,
+                           const char* end,
+                           std::size_t numVertices,
+                           const VertexLayout& layout,
+                           const char** pFieldBounds,
+                           io::PointBatch<FloatType>* pBatch);
+
+  template <typename FloatType, typename ScalarType>
+  static FloatType ScanScalar(const char* begin,
+                              const char* end,
+                              bool isColour);
+
+  template <typename ScalarType>
+  static ScalarType ParseScalar(const char* begin, const char* end);
+
+  void LoadFaces(const io::MappedFile& inputFile,
+                 const char* position,
+                 bool isAscii,
+                 const FaceLayout& layout);
+
+  static bool ReadFaces(const char** pPosition,
+                        const char* end,
+                        std::size_t numFaces,
+                        bool isAscii,
+                        const FaceLayout& layout,
+                        std::vector<const char*>* pFieldBounds,
+                        io::FaceBatch* pBatch);
+
+  template <typename IndexType>
+  static bool ReadFaces(const char** pPosition,
+                        const char* end,
+                        std::size_t numFaces,
+                        bool isAscii,
+                        const FaceLayout& layout,
+                        std::vector<const char*>* pFieldBounds,
+                        io::FaceBatch* pBatch);
+
+  template <typename CountType, typename IndexType>
+  static bool DecodeFaces(const char** pPosition,
+                          const char* end,
+                          std::size_t numFaces,
+                          bool isSwapped,
+                          io::FaceBatch* pBatch);
+
+  template <typename IndexType>
+  static bool ScanFaces(const char** pPosition,
+                        const char* end,
+                        std::size_t numFaces,
+                        std::size_t maxCount,
+                        std::vector<const char*>* pFieldBounds,
+                        io::FaceBatch* pBatch);
+
+  template <typename FloatType>
+  void FlushRecords(const FloatType* pColourTable,
+                    io::PointBatch<FloatType>* pBatch,
+                    InputAdapterInterface<FloatType>* pInputAdapter);
+
   void MessageCallBack(const std::string& messagePrefix,
                        const std::string& fileName,
                        std::size_t lineNumber,
@@ -97,26 +259,48 @@ private:
     const std::string& elementName,
     const std::string& propertyName);
 
+  template <typename ScalarType>
+  void ScalarPropertyCallback(std::size_t offset, ScalarType value);
+
+  template <typename SizeType, typename IndexType>
+  std::tr1::tuple<std::tr1::function<void (SizeType)>,
+                  std::tr1::function<void (IndexType)>,
+                  std::tr1::function<void ()> >
+  ListPropertyDefinitionCallback(
+    const std::string& elementName,
+    const std::string& propertyName);
+
+  template <typename ScalarType, typename Callbacks>
+  void AddScalarPropertyDefinitionCallback(Callbacks* pCallbacks);
+
+  template <typename SizeType, typename IndexType, typename Callbacks>
+  void AddListPropertyDefinitionCallback(Callbacks* pCallbacks);
+
+  template <typename IndexType>
+  void FaceIndexCallback(IndexType index);
+
+  void FaceBeginCallback();
+  void FaceEndCallback();
+  void FlushFaces();
+
+  void ResetRecordLayout();
   void VertexBeginCallback();
   void VertexEndCallback();
 
   boost::filesystem::path fInputPath;
 
-  boost::function<void (void)> fAdapterOnBeginPoint;
-  boost::function<void (double, double, double)> fAdapterOnPointPosition;
-  boost::function<void (double, double, double)> fAdapterOnPointNormal;
-  boost::function<void (double, double, double)> fAdapterOnPointColour;
-  boost::function<void (void)> fAdapterOnEndPoint;
-
-  double fPositionX;
-  double fPositionY;
-  double fPositionZ;
-  double fNormalX;
-  double fNormalY;
-  double fNormalZ;
-  double fColourR;
-  double fColourG;
-  double fColourB;
+  // The generic parser stores the vertex attributes as they are, one record
+  // per vertex laid out by fRecordLayout; fFlushRecords decodes the complete
+  // ones.
+  VertexLayout fRecordLayout;
+  std::vector<char> fRecords;
+  std::size_t fNumRecords;
+  boost::function<void (void)> fFlushRecords;
+  boost::function<void (std::size_t)> fBeginVertices;
+
+  io::FaceBatch fFaces;
+  boost::function<void (std::size_t)> fBeginFaces;
+  boost::function<void (const io::FaceBatch&)> fFlushFaces;
 };  // class
 
 
@@ -131,27 +315,514 @@ void
 PlyReader::Load
 (InputAdapterInterface<FloatType>* pInputAdapter)
 {
-  this->fAdapterOnBeginPoint =
-    boost::bind(&io::InputAdapterInterface<FloatType>::OnBeginPoint,
-                pInputAdapter);
+  this->fBeginFaces =
+    boost::bind(&io::InputAdapterInterface<FloatType>::OnBeginFaces,
+                pInputAdapter, _1);
+  this->fFlushFaces =
+    boost::bind(&io::InputAdapterInterface<FloatType>::OnFaceBatch,
+                pInputAdapter, _1);
+
+  if (!this->LoadVertices(pInputAdapter))
+  {
+    FloatType colourTable[256];
+    PlyReader::FillColourTable(colourTable);
+
+    io::PointBatch<FloatType> batch;
+    this->fFlushRecords =
+      boost::bind(&io::PlyReader::FlushRecords<FloatType>,
+                  this, colourTable, &batch, pInputAdapter);
+    this->fBeginVertices =
+      boost::bind(&io::InputAdapterInterface<FloatType>::OnBeginPoints,
+                  pInputAdapter, _1);
+
+    this->ParseFile();
+    this->FlushRecords(colourTable, &batch, pInputAdapter);
+    this->FlushFaces();
+    this->fFlushRecords = NULL;
+    this->fBeginVertices = NULL;
+  }
+
+  this->fBeginFaces = NULL;
+  this->fFlushFaces = NULL;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the vertices and faces of ASCII and binary files
+/// directly from the mapped file, batch by batch, without the generic parser
+/// and its stream operations and callbacks per scalar. Returns false, without
+/// reading anything, if the file needs the generic parser (see
+/// ReadLayout()). Malformed ASCII vertices are reported like the
+/// generic parser does; the vertices before them are kept.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+bool
+PlyReader::LoadVertices
+(InputAdapterInterface<FloatType>* pInputAdapter)
+{
+  io::MappedFile inputFile(this->fInputPath.string());
+  VertexLayout layout;
+  FaceLayout faceLayout;
+  if (!inputFile.IsOpen() ||
+      !PlyReader::ReadLayout(inputFile, &layout, &faceLayout))
+  {
+    return false;
+  }
+
+  FloatType colourTable[256];
+  PlyReader::FillColourTable(colourTable);
+
+  pInputAdapter->OnBeginPoints(layout.fNumVertices);
+
+  io::PointBatch<FloatType> batch;
+  const char* const pVertices = inputFile.GetBegin() + layout.fVerticesOffset;
+  if (layout.fFormat != VertexLayout::kFormatAscii)
+  {
+    for (std::size_t first = 0u;
+         first < layout.fNumVertices;
+         first += io::kPointBatchSize)
+    {
+      const std::size_t numVertices =
+        std::min(io::kPointBatchSize, layout.fNumVertices - first);
+      PlyReader::DecodeVertices(pVertices + first * layout.fRecordSize,
+                                numVertices, layout, colourTable, &batch);
+      pInputAdapter->OnPointBatch(batch);
+    }
+    this->LoadFaces(inputFile, NULL, false, faceLayout);
+    return true;
+  }
+
+  std::vector<const char*> fieldBounds(2u * layout.fNumProperties);
+  const char* position = pVertices;
+  for (std::size_t first = 0u;
+       first < layout.fNumVertices;
+       first += io::kPointBatchSize)
+  {
+    const std::size_t numVertices =
+      std::min(io::kPointBatchSize, layout.fNumVertices - first);
+    const bool isValid =
+      PlyReader::ScanVertices(&position, inputFile.GetEnd(), numVertices,
+                              layout, &fieldBounds[0], &batch);
+    if (!batch.IsEmpty())
+    {
+      pInputAdapter->OnPointBatch(batch);
+    }
+    if (!isValid)
+    {
+      // like the generic parser, a missing line is reported at the last one
+      const std::size_t lineNumber = layout.fVerticesLine + first +
+        batch.GetSize() - ((position == inputFile.GetEnd()) ? 1u : 0u);
+      this->MessageCallBack("Ply-Error", this->fInputPath.string(),
+                            lineNumber, "parse error");
+      return true;
+    }
+  }
+  this->LoadFaces(inputFile, position, true, faceLayout);
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// uint8 colours are by far the most common ones, binary files look them up.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PlyReader::FillColourTable
+(FloatType* pColourTable)
+{
+  for (unsigned int value = 0u; value < 256u; ++value)
+  {
+    pColourTable[value] =
+      PlyReader::ConvertScalar<FloatType>(static_cast<boost::uint8_t>(value),
+                                          true);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Converts a scalar of the file into the adapter's type, scaling integer
+/// colours to [0, 1].
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType, typename ScalarType>
+inline
+FloatType
+PlyReader::ConvertScalar
+(ScalarType value, bool isColour)
+{
+  if (std::numeric_limits<ScalarType>::is_integer && isColour)
+  {
+    return static_cast<FloatType>(
+      static_cast<double>(value) /
+      static_cast<double>(std::numeric_limits<ScalarType>::max()));
+  }
+  return static_cast<FloatType>(value);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Decodes a run of vertex records into the batch, one attribute at a time.
+/// Attributes missing in the file get the defaults of the generic parser.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PlyReader::DecodeVertices
+(const char* pRecords,
+ std::size_t numVertices,
+ const VertexLayout& layout,
+ const FloatType* pColourTable,
+ io::PointBatch<FloatType>* pBatch)
+{
+  pBatch->Clear();
+  pBatch->fPositions.resize(3u * numVertices);
+  pBatch->fNormals.resize(3u * numVertices);
+  pBatch->fColours.resize(3u * numVertices);
+  pBatch->fTexCoordOffsets.assign(numVertices + 1u, 0u);
+
+  const std::size_t recordSize = layout.fRecordSize;
+  for (unsigned int slot = 0u; slot < VertexLayout::kNumSlots; ++slot)
+  {
+    std::vector<FloatType>& attribute =
+      (slot < 3u) ? pBatch->fPositions :
+      (slot < 6u) ? pBatch->fNormals : pBatch->fColours;
+    FloatType* pTarget = &attribute[slot % 3u];
+    const char* pSource = pRecords + layout.fOffsets[slot];
+    const bool isColour = (slot >= 6u);
+    const VertexLayout::ScalarType type = layout.fTypes[slot];
+
+    if (type == VertexLayout::kScalarTypeUint8 && isColour)
+    {
+      for (std::size_t vertex = 0u; vertex < numVertices; ++vertex)
+      {
+        pTarget[3u * vertex] =
+          pColourTable[static_cast<unsigned char>(*pSource)];
+        pSource += recordSize;
+      }
+    }
+    else if (type == VertexLayout::kScalarTypeInt8)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::int8_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeInt16)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::int16_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeInt32)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::int32_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeUint8)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::uint8_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeUint16)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::uint16_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeUint32)
+    {
+      PlyReader::DecodeAttribute<FloatType, boost::uint32_t>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeFloat32)
+    {
+      PlyReader::DecodeAttribute<FloatType, float>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else if (type == VertexLayout::kScalarTypeFloat64)
+    {
+      PlyReader::DecodeAttribute<FloatType, double>(
+        pSource, recordSize, numVertices, isColour,
+        layout.fIsSwapped, pTarget);
+    }
+    else
+    {
+      const FloatType value = static_cast<FloatType>(isColour ? 1.0 : 0.0);
+      for (std::size_t vertex = 0u; vertex < numVertices; ++vertex)
+      {
+        pTarget[3u * vertex] = value;
+      }
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Decodes one attribute of a run of vertex records, converting straight
+/// from the file's scalar type. The branch on isColour is hoisted out of the
+/// loop so that each loop converts a single way. Swapped attributes are
+/// gathered into blocks first, which are swapped at once (see
+/// io::ByteOrder::SwapScalars()); the other properties of the records are
+/// not touched.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType, typename ScalarType>
+void
+PlyReader::DecodeAttribute
+(const char* pSource,
+ std::size_t recordSize,
+ std::size_t numVertices,
+ bool isColour,
+ bool isSwapped,
+ FloatType* pTarget)
+{
+  ScalarType value;
+  if (isSwapped && sizeof(ScalarType) > 1u)
+  {
+    const std::size_t kBlockSize = 256u;
+    char block[kBlockSize * sizeof(ScalarType)];
+    for (std::size_t first = 0u; first < numVertices; first += kBlockSize)
+    {
+      const std::size_t blockSize = std::min(kBlockSize, numVertices - first);
+      for (std::size_t vertex = 0u; vertex < blockSize; ++vertex)
+      {
+        std::memcpy(block + vertex * sizeof(ScalarType), pSource,
+                    sizeof(ScalarType));
+        pSource += recordSize;
+      }
+      io::ByteOrder::SwapScalars(block, blockSize, sizeof(ScalarType));
+      for (std::size_t vertex = 0u; vertex < blockSize; ++vertex)
+      {
+        std::memcpy(&value, block + vertex * sizeof(ScalarType),
+                    sizeof(value));
+        pTarget[3u * (first + vertex)] =
+          PlyReader::ConvertScalar<FloatType>(value, isColour);
+      }
+    }
+  }
+  else if (std::numeric_limits<ScalarType>::is_integer && isColour)
+  {
+    for (std::size_t vertex = 0u; vertex < numVertices; ++vertex)
+    {
+      std::memcpy(&value, pSource, sizeof(value));
+      pTarget[3u * vertex] = PlyReader::ConvertScalar<FloatType>(value, true);
+      pSource += recordSize;
+    }
+  }
+  else
+  {
+    for (std::size_t vertex = 0u; vertex < numVertices; ++vertex)
+    {
+      std::memcpy(&value, pSource, sizeof(value));
+      pTarget[3u * vertex] = static_cast<FloatType>(value);
+      pSource += recordSize;
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses a run of ASCII vertex lines into the batch, advancing *pPosition.
+/// Returns false at the first malformed or missing line, with *pPosition at
+/// that line and the vertices before it in the batch. Fields the reader
+/// does not use are counted, but not converted.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+bool
+PlyReader::ScanVertices
+(const char** pPosition,
+ const char* end,
+ std::size_t numVertices,
+ const VertexLayout& layout,
+ const char** pFieldBounds,
+ io::PointBatch<FloatType>* pBatch)
+{
+  namespace iort = io::ReaderTools;
+
+  pBatch->Clear();
+  pBatch->fPositions.resize(3u * numVertices);
+  pBatch->fNormals.resize(3u * numVertices);
+  pBatch->fColours.resize(3u * numVertices);
+  pBatch->fTexCoordOffsets.assign(numVertices + 1u, 0u);
+
+  // one vertex per line, as required by the generic parser
+  std::size_t vertex = 0u;
+  const char* begin = *pPosition;
+  try
+  {
+    for (; vertex < numVertices && begin != end; ++vertex)
+    {
+      const char* lineEnd = static_cast<const char*>(
+        std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+      const char* const next = (lineEnd == NULL) ? end : lineEnd + 1;
+      if (lineEnd == NULL)
+      {
+        lineEnd = end;
+      }
+      if (iort::SplitFields(begin, lineEnd, layout.fNumProperties,
+                            pFieldBounds) != layout.fNumProperties)
+      {
+        break;
+      }
+
+      for (unsigned int slot = 0u; slot < VertexLayout::kNumSlots; ++slot)
+      {
+        std::vector<FloatType>& attribute =
+          (slot < 3u) ? pBatch->fPositions :
+          (slot < 6u) ? pBatch->fNormals : pBatch->fColours;
+        FloatType& target = attribute[3u * vertex + slot % 3u];
+        const char* const* pField = pFieldBounds + 2u * layout.fOffsets[slot];
+        const bool isColour = (slot >= 6u);
+        const VertexLayout::ScalarType type = layout.fTypes[slot];
+
+        if (type == VertexLayout::kScalarTypeFloat32)
+        {
+          target = PlyReader::ScanScalar<FloatType, float>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeUint8)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::uint8_t>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeFloat64)
+        {
+          target = PlyReader::ScanScalar<FloatType, double>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeInt8)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::int8_t>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeInt16)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::int16_t>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeInt32)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::int32_t>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeUint16)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::uint16_t>(
+            pField[0], pField[1], isColour);
+        }
+        else if (type == VertexLayout::kScalarTypeUint32)
+        {
+          target = PlyReader::ScanScalar<FloatType, boost::uint32_t>(
+            pField[0], pField[1], isColour);
+        }
+        else
+        {
+          target = static_cast<FloatType>(isColour ? 1.0 : 0.0);
+        }
+      }
+      begin = next;
+    }
+  }
+  catch (const boost::bad_lexical_cast&)
+  {
+  }
+
+  *pPosition = begin;
+  pBatch->Truncate(vertex);
+  return (vertex == numVertices);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses one ASCII field as the file's scalar type and converts it.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType, typename ScalarType>
+inline
+FloatType
+PlyReader::ScanScalar
+(const char* begin,
+ const char* end,
+ bool isColour)
+{
+  return PlyReader::ConvertScalar<FloatType>(
+    PlyReader::ParseScalar<ScalarType>(begin, end), isColour);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses one ASCII field as the file's scalar type. Integers are parsed as
+/// int or unsigned int and must fit their type.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ScalarType>
+inline
+ScalarType
+PlyReader::ParseScalar
+(const char* begin, const char* end)
+{
+  typedef typename boost::mpl::if_c<
+    std::numeric_limits<ScalarType>::is_integer,
+    typename boost::mpl::if_c<std::numeric_limits<ScalarType>::is_signed,
+                              int, unsigned int>::type,
+    ScalarType>::type ParseType;
+
+  const ParseType parsed = io::ReaderTools::Parse<ParseType>(begin, end);
+  const ScalarType value = static_cast<ScalarType>(parsed);
+  if (static_cast<ParseType>(value) != parsed)
+  {
+    io::ReaderTools::ThrowBadToken<ScalarType>();
+  }
+  return value;
+}
 
-  this->fAdapterOnPointPosition =
-  boost::bind(&io::InputAdapterInterface<FloatType>::OnPointPosition,
-              pInputAdapter, _1, _2, _3);
 
-  this->fAdapterOnPointNormal =
-  boost::bind(&io::InputAdapterInterface<FloatType>::OnPointNormal,
-              pInputAdapter, _1, _2, _3);
 
-  this->fAdapterOnPointColour =
-  boost::bind(&io::InputAdapterInterface<FloatType>::OnPointColour,
-              pInputAdapter, _1, _2, _3);
 
-  this->fAdapterOnEndPoint =
-    boost::bind(&io::InputAdapterInterface<FloatType>::OnEndPoint,
-                pInputAdapter);
 
-  this->ParseFile();
+////////////////////////////////////////////////////////////////////////////////
+/// Decodes the records the generic parser has filled so far and hands them
+/// to the adapter.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PlyReader::FlushRecords
+(const FloatType* pColourTable,
+ io::PointBatch<FloatType>* pBatch,
+ InputAdapterInterface<FloatType>* pInputAdapter)
+{
+  if (this->fNumRecords == 0u)
+  {
+    return;
+  }
+
+  PlyReader::DecodeVertices(&this->fRecords[0], this->fNumRecords,
+                            this->fRecordLayout, pColourTable, pBatch);
+  pInputAdapter->OnPointBatch(*pBatch);
+  this->fRecords.clear();
+  this->fNumRecords = 0u;
 }
 
 
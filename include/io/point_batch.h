@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__POINT_BATCH_H_
+#define AVIGLE__IO__POINT_BATCH_H_
+
+
+#include <cstddef>
+
+#include <vector>
+
+
+namespace io
+{
+
+/// Number of points readers collect before handing them to an adapter.
+const std::size_t kPointBatchSize = 4096u;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// A run of points in structure-of-arrays layout. Positions, normals and
+/// colours hold three values per point, confidences one; normals, colours and
+/// confidences stay empty if the source does not provide them (readers never
+/// provide confidences, writers pull them from output adapters). Texture
+/// coordinates are stored compressed:
+/// the coordinates of point i are the entries
+/// [fTexCoordOffsets[i], fTexCoordOffsets[i + 1]) of fTexCoordIds and, with
+/// two values each, of fTexCoords.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+struct PointBatch
+{
+  std::vector<FloatType> fPositions;
+  std::vector<FloatType> fNormals;
+  std::vector<FloatType> fColours;
+  std::vector<FloatType> fConfidences;
+  std::vector<unsigned int> fTexCoordOffsets;
+  std::vector<unsigned int> fTexCoordIds;
+  std::vector<FloatType> fTexCoords;
+
+  PointBatch()
+  : fTexCoordOffsets(1u, 0u)
+  {}
+
+  std::size_t GetSize() const { return this->fTexCoordOffsets.size() - 1u; }
+  bool IsEmpty() const { return (this->GetSize() == 0u); }
+  bool HasNormals() const { return !this->fNormals.empty(); }
+  bool HasColours() const { return !this->fColours.empty(); }
+  bool HasConfidences() const { return !this->fConfidences.empty(); }
+
+  void Swap(PointBatch& other)
+  {
+    this->fPositions.swap(other.fPositions);
+    this->fNormals.swap(other.fNormals);
+    this->fColours.swap(other.fColours);
+    this->fConfidences.swap(other.fConfidences);
+    this->fTexCoordOffsets.swap(other.fTexCoordOffsets);
+    this->fTexCoordIds.swap(other.fTexCoordIds);
+    this->fTexCoords.swap(other.fTexCoords);
+  }
+
+  /// Drops all points from numPoints on.
+  void Truncate(std::size_t numPoints)
+  {
+    if (numPoints >= this->GetSize())
+    {
+      return;
+    }
+    const unsigned int numTexCoords = this->fTexCoordOffsets[numPoints];
+    this->fPositions.resize(3u * numPoints);
+    if (this->HasNormals())
+    {
+      this->fNormals.resize(3u * numPoints);
+    }
+    if (this->HasColours())
+    {
+      this->fColours.resize(3u * numPoints);
+    }
+    if (this->HasConfidences())
+    {
+      this->fConfidences.resize(numPoints);
+    }
+    this->fTexCoordOffsets.resize(numPoints + 1u);
+    this->fTexCoordIds.resize(numTexCoords);
+    this->fTexCoords.resize(2u * numTexCoords);
+  }
+
+  /// Replaces the points with the points [first, last) of another batch.
+  void AssignRange(const PointBatch& other, std::size_t first, std::size_t last)
+  {
+    const unsigned int firstTexCoord = other.fTexCoordOffsets[first];
+    const unsigned int lastTexCoord = other.fTexCoordOffsets[last];
+    this->fPositions.assign(other.fPositions.begin() + 3u * first,
+                            other.fPositions.begin() + 3u * last);
+    this->fNormals.clear();
+    if (other.HasNormals())
+    {
+      this->fNormals.assign(other.fNormals.begin() + 3u * first,
+                            other.fNormals.begin() + 3u * last);
+    }
+    this->fColours.clear();
+    if (other.HasColours())
+    {
+      this->fColours.assign(other.fColours.begin() + 3u * first,
+                            other.fColours.begin() + 3u * last);
+    }
+    this->fConfidences.clear();
+    if (other.HasConfidences())
+    {
+      this->fConfidences.assign(other.fConfidences.begin() + first,
+                                other.fConfidences.begin() + last);
+    }
+    this->fTexCoordOffsets.resize(last - first + 1u);
+    for (std::size_t point = first; point <= last; ++point)
+    {
+      this->fTexCoordOffsets[point - first] =
+        other.fTexCoordOffsets[point] - firstTexCoord;
+    }
+    this->fTexCoordIds.assign(other.fTexCoordIds.begin() + firstTexCoord,
+                              other.fTexCoordIds.begin() + lastTexCoord);
+    this->fTexCoords.assign(other.fTexCoords.begin() + 2u * firstTexCoord,
+                            other.fTexCoords.begin() + 2u * lastTexCoord);
+  }
+
+  void Clear()
+  {
+    this->fPositions.clear();
+    this->fNormals.clear();
+    this->fColours.clear();
+    this->fConfidences.clear();
+    this->fTexCoordOffsets.resize(1u);
+    this->fTexCoordIds.clear();
+    this->fTexCoords.clear();
+  }
+
+  void AddPosition(FloatType x, FloatType y, FloatType z)
+  {
+    this->fPositions.push_back(x);
+    this->fPositions.push_back(y);
+    this->fPositions.push_back(z);
+  }
+
+  void AddNormal(FloatType x, FloatType y, FloatType z)
+  {
+    this->fNormals.push_back(x);
+    this->fNormals.push_back(y);
+    this->fNormals.push_back(z);
+  }
+
+  void AddColour(FloatType r, FloatType g, FloatType b)
+  {
+    this->fColours.push_back(r);
+    this->fColours.push_back(g);
+    this->fColours.push_back(b);
+  }
+
+  void AddConfidence(FloatType confidence)
+  {
+    this->fConfidences.push_back(confidence);
+  }
+
+  void AddTexCoord(unsigned int id, FloatType u, FloatType v)
+  {
+    this->fTexCoordIds.push_back(id);
+    this->fTexCoords.push_back(u);
+    this->fTexCoords.push_back(v);
+  }
+
+  /// Closes the point whose attributes were added last.
+  void EndPoint()
+  {
+    this->fTexCoordOffsets.push_back(
+      static_cast<unsigned int>(this->fTexCoordIds.size()));
+  }
+};  // struct
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__POINT_BATCH_H_
@@ -0,0 +1,587 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__POINT_CLOUD_H_
+#define AVIGLE__IO__POINT_CLOUD_H_
+
+
+#include <algorithm>
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <io/input_adapter_interface.h>
+#include <io/point_batch.h>
+
+
+namespace io
+{
+
+/// Alignment in bytes of the attribute arrays of a PointCloud.
+const std::size_t kPointCloudAlignment = 64u;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Stores a loaded data set in structure-of-arrays layout. Positions, normals
+/// and colours are arrays of three values per point, aligned to
+/// kPointCloudAlignment bytes. Normals and colours stay empty if the input
+/// does not provide them. Texture coordinates use the same compressed layout
+/// as PointBatch: the coordinates of point i are the entries
+/// [offsets[i], offsets[i + 1]) of the ids and, with two values each, of the
+/// coordinates. Textures are kept in the order they were loaded.
+///
+/// Point batches may be added from several threads at once, so readers can
+/// fill the cloud directly from their worker threads. The per-point
+/// callbacks must be called from one thread only.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+class PointCloud
+: public io::InputAdapterInterface<FloatType>
+, private boost::noncopyable
+{
+public:
+  typedef std::vector<FloatType,
+                      boost::alignment::aligned_allocator<
+                        FloatType, io::kPointCloudAlignment> > FloatArray;
+
+  struct Texture
+  {
+    unsigned int fId;
+    std::string fFileName;
+    unsigned int fWidth;
+    unsigned int fHeight;
+    FloatType fPosition[3];
+    FloatType fDirection[3];
+    FloatType fRotation[9];
+    FloatType fOffset[3];
+    FloatType fOffsetU;
+    FloatType fOffsetV;
+  };
+
+  PointCloud();
+  virtual ~PointCloud() {}
+
+  void Reserve(std::size_t numPoints,
+               std::size_t numTexCoords = 0u,
+               std::size_t numTextures = 0u);
+  void Clear();
+
+  std::size_t GetNumPoints() const { return this->fNumPoints; }
+  std::size_t GetNumTexCoords() const { return this->fTexCoordIds.size(); }
+  std::size_t GetNumTextures() const { return this->fTextures.size(); }
+  bool HasNormals() const { return !this->fNormals.empty(); }
+  bool HasColours() const { return !this->fColours.empty(); }
+
+  const FloatArray& GetPositions() const { return this->fPositions; }
+  const FloatArray& GetNormals() const { return this->fNormals; }
+  const FloatArray& GetColours() const { return this->fColours; }
+  const std::vector<boost::uint64_t>& GetTexCoordOffsets() const
+  {
+    return this->fTexCoordOffsets;
+  }
+  const std::vector<unsigned int>& GetTexCoordIds() const
+  {
+    return this->fTexCoordIds;
+  }
+  const FloatArray& GetTexCoords() const { return this->fTexCoords; }
+  const std::vector<Texture>& GetTextures() const { return this->fTextures; }
+
+  std::size_t GetMemoryUsage() const;
+
+  // InputAdapterInterface
+  virtual void OnBeginPoint() {}
+  virtual void OnPointPosition(FloatType x, FloatType y, FloatType z);
+  virtual void OnPointNormal(FloatType x, FloatType y, FloatType z);
+  virtual void OnPointColour(FloatType r, FloatType g, FloatType b);
+  virtual void OnPointTexCoord(unsigned int id, FloatType u, FloatType v);
+  virtual void OnEndPoint();
+
+  virtual void OnBeginTextures(std::size_t numTextures);
+  virtual void OnBeginPoints(std::size_t numPoints);
+
+  virtual void OnPointBatch(const io::PointBatch<FloatType>& batch);
+  virtual bool AcceptsConcurrentBatches() const { return true; }
+
+  virtual void OnTexture(
+    unsigned int id,
+    const std::string& fileName,
+    unsigned int width, unsigned int height,
+    FloatType camPosX, FloatType camPosY, FloatType camPosZ,
+    FloatType camDirX, FloatType camDirY, FloatType camDirZ,
+    FloatType m11, FloatType m12, FloatType m13,
+    FloatType m21, FloatType m22, FloatType m23,
+    FloatType m31, FloatType m32, FloatType m33,
+    FloatType offsetX, FloatType offsetY, FloatType offsetZ,
+    FloatType offsetU, FloatType offsetV);
+
+private:
+  static FloatType GetDefaultColour() { return static_cast<FloatType>(1.0); }
+
+  void ReserveAttribute(FloatArray* pAttribute, std::size_t numPoints);
+  void ReserveTexCoords(std::size_t numTexCoords);
+
+  std::size_t fNumPoints;
+  std::size_t fNumReservedPoints;
+  FloatArray fPositions;
+  FloatArray fNormals;
+  FloatArray fColours;
+  std::vector<boost::uint64_t> fTexCoordOffsets;
+  std::vector<unsigned int> fTexCoordIds;
+  FloatArray fTexCoords;
+  std::vector<Texture> fTextures;
+
+  // Batches grow the arrays under an exclusive lock and copy their points
+  // under a shared lock, so several batches are copied at the same time.
+  boost::shared_mutex fGrowMutex;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+PointCloud<FloatType>::PointCloud
+()
+: fNumPoints(0u)
+, fNumReservedPoints(0u)
+, fTexCoordOffsets(1u, 0u)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Allocates memory for the given numbers of points, texture coordinates and
+/// textures. Normals and colours are allocated once the first point that has
+/// them is added.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::Reserve
+(std::size_t numPoints,
+ std::size_t numTexCoords,
+ std::size_t numTextures)
+{
+  this->fNumReservedPoints = std::max(this->fNumReservedPoints, numPoints);
+  this->fPositions.reserve(3u * numPoints);
+  if (this->HasNormals())
+  {
+    this->fNormals.reserve(3u * numPoints);
+  }
+  if (this->HasColours())
+  {
+    this->fColours.reserve(3u * numPoints);
+  }
+  this->fTexCoordOffsets.reserve(numPoints + 1u);
+  this->fTexCoordIds.reserve(numTexCoords);
+  this->fTexCoords.reserve(2u * numTexCoords);
+  this->fTextures.reserve(numTextures);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::Clear
+()
+{
+  this->fNumPoints = 0u;
+  this->fNumReservedPoints = 0u;
+  this->fPositions.clear();
+  this->fNormals.clear();
+  this->fColours.clear();
+  this->fTexCoordOffsets.assign(1u, 0u);
+  this->fTexCoordIds.clear();
+  this->fTexCoords.clear();
+  this->fTextures.clear();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the number of bytes allocated for points and textures.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+std::size_t
+PointCloud<FloatType>::GetMemoryUsage
+()
+const
+{
+  std::size_t numBytes =
+    sizeof(FloatType) * (this->fPositions.capacity() +
+                         this->fNormals.capacity() +
+                         this->fColours.capacity() +
+                         this->fTexCoords.capacity()) +
+    sizeof(boost::uint64_t) * this->fTexCoordOffsets.capacity() +
+    sizeof(unsigned int) * this->fTexCoordIds.capacity() +
+    sizeof(Texture) * this->fTextures.capacity();
+  for (std::size_t texture = 0u; texture < this->fTextures.size(); ++texture)
+  {
+    numBytes += this->fTextures[texture].fFileName.capacity();
+  }
+  return numBytes;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnPointPosition
+(FloatType x, FloatType y, FloatType z)
+{
+  this->fPositions.push_back(x);
+  this->fPositions.push_back(y);
+  this->fPositions.push_back(z);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Points added before the first normal get a zero normal.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnPointNormal
+(FloatType x, FloatType y, FloatType z)
+{
+  this->ReserveAttribute(&this->fNormals, this->fNumPoints + 1u);
+  this->fNormals.resize(3u * this->fNumPoints, static_cast<FloatType>(0.0));
+  this->fNormals.push_back(x);
+  this->fNormals.push_back(y);
+  this->fNormals.push_back(z);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnBeginTextures
+(std::size_t numTextures)
+{
+  this->fTextures.reserve(this->fTextures.size() + numTextures);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reserves the points announced by the reader in addition to those loaded
+/// before.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnBeginPoints
+(std::size_t numPoints)
+{
+  boost::unique_lock<boost::shared_mutex> lock(this->fGrowMutex);
+  this->Reserve(this->fNumPoints + numPoints);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Points added before the first colour are white.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnPointColour
+(FloatType r, FloatType g, FloatType b)
+{
+  this->ReserveAttribute(&this->fColours, this->fNumPoints + 1u);
+  this->fColours.resize(3u * this->fNumPoints, GetDefaultColour());
+  this->fColours.push_back(r);
+  this->fColours.push_back(g);
+  this->fColours.push_back(b);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnPointTexCoord
+(unsigned int id, FloatType u, FloatType v)
+{
+  this->ReserveTexCoords(this->fTexCoordIds.size() + 1u);
+  this->fTexCoordIds.push_back(id);
+  this->fTexCoords.push_back(u);
+  this->fTexCoords.push_back(v);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fills in attributes the point did not provide, so all arrays keep one
+/// entry per point.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnEndPoint
+()
+{
+  ++this->fNumPoints;
+  this->fPositions.resize(3u * this->fNumPoints, static_cast<FloatType>(0.0));
+  if (this->HasNormals())
+  {
+    this->fNormals.resize(3u * this->fNumPoints, static_cast<FloatType>(0.0));
+  }
+  if (this->HasColours())
+  {
+    this->fColours.resize(3u * this->fNumPoints, GetDefaultColour());
+  }
+  this->fTexCoordOffsets.push_back(this->fTexCoordIds.size());
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Appends the points of a batch. May be called from several threads at
+/// once; each batch ends up as one contiguous run of points.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnPointBatch
+(const io::PointBatch<FloatType>& batch)
+{
+  const std::size_t numPoints = batch.GetSize();
+  const std::size_t numTexCoords = batch.fTexCoordIds.size();
+  if (numPoints == 0u)
+  {
+    return;
+  }
+
+  std::size_t firstPoint = 0u;
+  std::size_t firstTexCoord = 0u;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(this->fGrowMutex);
+    firstPoint = this->fNumPoints;
+    firstTexCoord = this->fTexCoordIds.size();
+    this->fNumPoints += numPoints;
+
+    this->fPositions.resize(3u * this->fNumPoints);
+    if (batch.HasNormals() || this->HasNormals())
+    {
+      this->ReserveAttribute(&this->fNormals, this->fNumPoints);
+      this->fNormals.resize(3u * this->fNumPoints,
+                            static_cast<FloatType>(0.0));
+    }
+    if (batch.HasColours() || this->HasColours())
+    {
+      this->ReserveAttribute(&this->fColours, this->fNumPoints);
+      this->fColours.resize(3u * this->fNumPoints, GetDefaultColour());
+    }
+    this->ReserveTexCoords(firstTexCoord + numTexCoords);
+    this->fTexCoordOffsets.resize(this->fNumPoints + 1u);
+    this->fTexCoordIds.resize(firstTexCoord + numTexCoords);
+    this->fTexCoords.resize(2u * (firstTexCoord + numTexCoords));
+    this->fTexCoordOffsets[this->fNumPoints] = this->fTexCoordIds.size();
+  }
+
+  boost::shared_lock<boost::shared_mutex> lock(this->fGrowMutex);
+  std::copy(batch.fPositions.begin(), batch.fPositions.end(),
+            this->fPositions.begin() + 3u * firstPoint);
+  if (batch.HasNormals())
+  {
+    std::copy(batch.fNormals.begin(), batch.fNormals.end(),
+              this->fNormals.begin() + 3u * firstPoint);
+  }
+  if (batch.HasColours())
+  {
+    std::copy(batch.fColours.begin(), batch.fColours.end(),
+              this->fColours.begin() + 3u * firstPoint);
+  }
+  for (std::size_t point = 0u; point < numPoints; ++point)
+  {
+    this->fTexCoordOffsets[firstPoint + point] =
+      firstTexCoord + batch.fTexCoordOffsets[point];
+  }
+  std::copy(batch.fTexCoordIds.begin(), batch.fTexCoordIds.end(),
+            this->fTexCoordIds.begin() + firstTexCoord);
+  std::copy(batch.fTexCoords.begin(), batch.fTexCoords.end(),
+            this->fTexCoords.begin() + 2u * firstTexCoord);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::OnTexture
+(unsigned int id,
+ const std::string& fileName,
+ unsigned int width, unsigned int height,
+ FloatType camPosX, FloatType camPosY, FloatType camPosZ,
+ FloatType camDirX, FloatType camDirY, FloatType camDirZ,
+ FloatType m11, FloatType m12, FloatType m13,
+ FloatType m21, FloatType m22, FloatType m23,
+ FloatType m31, FloatType m32, FloatType m33,
+ FloatType offsetX, FloatType offsetY, FloatType offsetZ,
+ FloatType offsetU, FloatType offsetV)
+{
+  Texture texture;
+  texture.fId = id;
+  texture.fFileName = fileName;
+  texture.fWidth = width;
+  texture.fHeight = height;
+  texture.fPosition[0] = camPosX;
+  texture.fPosition[1] = camPosY;
+  texture.fPosition[2] = camPosZ;
+  texture.fDirection[0] = camDirX;
+  texture.fDirection[1] = camDirY;
+  texture.fDirection[2] = camDirZ;
+  texture.fRotation[0] = m11;
+  texture.fRotation[1] = m12;
+  texture.fRotation[2] = m13;
+  texture.fRotation[3] = m21;
+  texture.fRotation[4] = m22;
+  texture.fRotation[5] = m23;
+  texture.fRotation[6] = m31;
+  texture.fRotation[7] = m32;
+  texture.fRotation[8] = m33;
+  texture.fOffset[0] = offsetX;
+  texture.fOffset[1] = offsetY;
+  texture.fOffset[2] = offsetZ;
+  texture.fOffsetU = offsetU;
+  texture.fOffsetV = offsetV;
+  this->fTextures.push_back(texture);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Normals and colours are allocated once the first point that has them is
+/// added. Allocates them for all reserved points, at least numPoints, at
+/// that time.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::ReserveAttribute
+(FloatArray* pAttribute, std::size_t numPoints)
+{
+  if (pAttribute->empty())
+  {
+    pAttribute->reserve(3u * std::max(this->fNumReservedPoints, numPoints));
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// The number of texture coordinates is not known up front. Once the
+/// reserved memory does not suffice, extrapolates from the points loaded so
+/// far to the reserved points, instead of growing geometrically. Beyond the
+/// reserved points the arrays grow as usual.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+PointCloud<FloatType>::ReserveTexCoords
+(std::size_t numTexCoords)
+{
+  if (numTexCoords <= this->fTexCoordIds.capacity() ||
+      this->fNumPoints == 0u ||
+      this->fNumPoints > this->fNumReservedPoints)
+  {
+    return;
+  }
+
+  const std::size_t estimate =
+    numTexCoords * this->fNumReservedPoints / this->fNumPoints;
+  this->fTexCoordIds.reserve(estimate);
+  this->fTexCoords.reserve(2u * estimate);
+}
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__POINT_CLOUD_H_
@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__POINT_CLOUD_OUTPUT_ADAPTER_H_
+#define AVIGLE__IO__POINT_CLOUD_OUTPUT_ADAPTER_H_
+
+
+#include <cstddef>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <io/output_adapter_interface.h>
+#include <io/point_cloud.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the contents of a PointCloud to a writer. Points without colour are
+/// written white; confidences are not stored in a PointCloud and written as
+/// zero.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+class PointCloudOutputAdapter : public io::OutputAdapterInterface<FloatType>
+{
+public:
+  PointCloudOutputAdapter(const io::PointCloud<FloatType>& pointCloud)
+  : fPointCloud(pointCloud)
+  , fTexture(0u)
+  , fPoint(0u)
+  , fTexCoord(0u)
+  , fHasTexture(false)
+  , fHasPoint(false)
+  {}
+  virtual ~PointCloudOutputAdapter() {}
+
+  virtual unsigned int CountTextures()
+  {
+    return static_cast<unsigned int>(this->fPointCloud.GetNumTextures());
+  }
+  virtual void FetchNextTexture()
+  {
+    this->fTexture += this->fHasTexture ? 1u : 0u;
+    this->fHasTexture = true;
+  }
+  virtual void GetTextureID(unsigned int *id)
+  {
+    *id = this->GetTexture().fId;
+  }
+  virtual void GetTextureFilename(std::string *filename)
+  {
+    *filename = this->GetTexture().fFileName;
+  }
+  virtual void GetTextureSize(unsigned int *width, unsigned int *height)
+  {
+    *width = this->GetTexture().fWidth;
+    *height = this->GetTexture().fHeight;
+  }
+  virtual void GetTexturePosition(FloatType *camPosX,
+                                  FloatType *camPosY,
+                                  FloatType *camPosZ)
+  {
+    *camPosX = this->GetTexture().fPosition[0];
+    *camPosY = this->GetTexture().fPosition[1];
+    *camPosZ = this->GetTexture().fPosition[2];
+  }
+  virtual void GetTextureDirection(FloatType *camDirX,
+                                   FloatType *camDirY,
+                                   FloatType *camDirZ)
+  {
+    *camDirX = this->GetTexture().fDirection[0];
+    *camDirY = this->GetTexture().fDirection[1];
+    *camDirZ = this->GetTexture().fDirection[2];
+  }
+
+  virtual unsigned int CountPoints()
+  {
+    return static_cast<unsigned int>(this->fPointCloud.GetNumPoints());
+  }
+  virtual void FetchNextPoint()
+  {
+    this->fPoint += this->fHasPoint ? 1u : 0u;
+    this->fHasPoint = true;
+    this->fTexCoord = static_cast<std::size_t>(
+      this->fPointCloud.GetTexCoordOffsets()[this->fPoint]);
+  }
+  virtual void GetPointPosition(FloatType *x, FloatType *y, FloatType *z)
+  {
+    const FloatType* position =
+      &this->fPointCloud.GetPositions()[3u * this->fPoint];
+    *x = position[0];
+    *y = position[1];
+    *z = position[2];
+  }
+  virtual void GetPointColour(FloatType *r, FloatType *g, FloatType *b)
+  {
+    if (!this->fPointCloud.HasColours())
+    {
+      *r = *g = *b = static_cast<FloatType>(1.0);
+      return;
+    }
+    const FloatType* colour =
+      &this->fPointCloud.GetColours()[3u * this->fPoint];
+    *r = colour[0];
+    *g = colour[1];
+    *b = colour[2];
+  }
+  virtual void GetPointConfidence(FloatType *conf)
+  {
+    *conf = static_cast<FloatType>(0.0);
+  }
+  virtual unsigned int CountPointTextureCoordinates()
+  {
+    return static_cast<unsigned int>(
+      this->fPointCloud.GetTexCoordOffsets()[this->fPoint + 1u] -
+      this->fPointCloud.GetTexCoordOffsets()[this->fPoint]);
+  }
+  virtual void FetchNextPointTextureCoordinate() {}
+  virtual void GetPointTextureCoordinate(unsigned int *imId,
+                                         FloatType *u,
+                                         FloatType *v)
+  {
+    *imId = this->fPointCloud.GetTexCoordIds()[this->fTexCoord];
+    *u = this->fPointCloud.GetTexCoords()[2u * this->fTexCoord];
+    *v = this->fPointCloud.GetTexCoords()[2u * this->fTexCoord + 1u];
+    ++this->fTexCoord;
+  }
+
+  virtual void FetchPointBatch(io::PointBatch<FloatType> *pBatch,
+                               unsigned int numPoints)
+  {
+    const std::size_t first = this->fHasPoint ? this->fPoint + 1u : 0u;
+    const std::size_t last = first + numPoints;
+    const std::vector<boost::uint64_t>& offsets =
+      this->fPointCloud.GetTexCoordOffsets();
+
+    pBatch->fPositions.assign(
+      this->fPointCloud.GetPositions().begin() + 3u * first,
+      this->fPointCloud.GetPositions().begin() + 3u * last);
+    if (this->fPointCloud.HasColours())
+    {
+      pBatch->fColours.assign(
+        this->fPointCloud.GetColours().begin() + 3u * first,
+        this->fPointCloud.GetColours().begin() + 3u * last);
+    }
+    else
+    {
+      pBatch->fColours.assign(3u * numPoints, static_cast<FloatType>(1.0));
+    }
+    pBatch->fConfidences.assign(numPoints, static_cast<FloatType>(0.0));
+    pBatch->fNormals.clear();
+
+    pBatch->fTexCoordOffsets.resize(numPoints + 1u);
+    for (std::size_t point = 0u; point <= numPoints; ++point)
+    {
+      pBatch->fTexCoordOffsets[point] =
+        static_cast<unsigned int>(offsets[first + point] - offsets[first]);
+    }
+    pBatch->fTexCoordIds.assign(
+      this->fPointCloud.GetTexCoordIds().begin() + offsets[first],
+      this->fPointCloud.GetTexCoordIds().begin() + offsets[last]);
+    pBatch->fTexCoords.assign(
+      this->fPointCloud.GetTexCoords().begin() + 2u * offsets[first],
+      this->fPointCloud.GetTexCoords().begin() + 2u * offsets[last]);
+
+    if (numPoints > 0u)
+    {
+      this->fPoint = last - 1u;
+      this->fHasPoint = true;
+    }
+  }
+
+  virtual bool SupportsRandomAccess() const { return true; }
+  virtual void GetPoint(unsigned int index,
+                        FloatType *position,
+                        FloatType *colour,
+                        FloatType *conf) const
+  {
+    std::copy(&this->fPointCloud.GetPositions()[3u * index],
+              &this->fPointCloud.GetPositions()[3u * index] + 3u,
+              position);
+    if (this->fPointCloud.HasColours())
+    {
+      std::copy(&this->fPointCloud.GetColours()[3u * index],
+                &this->fPointCloud.GetColours()[3u * index] + 3u,
+                colour);
+    }
+    else
+    {
+      std::fill(colour, colour + 3u, static_cast<FloatType>(1.0));
+    }
+    *conf = static_cast<FloatType>(0.0);
+  }
+  virtual unsigned int GetPointTexCoords(unsigned int index,
+                                         const unsigned int **imIds,
+                                         const FloatType **texCoords) const
+  {
+    const std::size_t first = static_cast<std::size_t>(
+      this->fPointCloud.GetTexCoordOffsets()[index]);
+    const std::size_t last = static_cast<std::size_t>(
+      this->fPointCloud.GetTexCoordOffsets()[index + 1u]);
+    if (first != last)
+    {
+      *imIds = &this->fPointCloud.GetTexCoordIds()[first];
+      *texCoords = &this->fPointCloud.GetTexCoords()[2u * first];
+    }
+    return static_cast<unsigned int>(last - first);
+  }
+
+private:
+  const typename io::PointCloud<FloatType>::Texture& GetTexture() const
+  {
+    return this->fPointCloud.GetTextures()[this->fTexture];
+  }
+
+  const io::PointCloud<FloatType>& fPointCloud;
+  std::size_t fTexture;
+  std::size_t fPoint;
+  std::size_t fTexCoord;
+  bool fHasTexture;
+  bool fHasPoint;
+};  // class
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__POINT_CLOUD_OUTPUT_ADAPTER_H_
@@ -45,14 +45,34 @@
 #define AVIGLE__IO__READER_TOOLS_H_
 
 #include <cstdlib>
+#include <cstring>
 
+#include <fstream>
 #include <limits>
 #include <string>
+#include <typeinfo>
 #include <utility>
 
+#if __cplusplus >= 201703L
+  #include <charconv>
+#endif
+
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
+
+#include <io/mapped_file.h>
+
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+  #define AVIGLE__IO__HAS_CHARCONV
+#else
+  #include <boost/spirit/include/qi_parse.hpp>
+  #include <boost/spirit/include/qi_real.hpp>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__)
+  #include <emmintrin.h>
+  #define AVIGLE__IO__HAS_SSE2_SPLIT
+#endif
 
 
 namespace io
@@ -65,22 +85,98 @@ namespace ReaderTools
 {
 
 typedef void Unused;
-typedef boost::char_separator<char> Delimiter;
-typedef boost::tokenizer<Delimiter> Tokenizer;
-typedef Tokenizer::iterator TokenIter;
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Splits a line into tokens without copying them. The tokens are views into
+/// either an external buffer (see Assign()) or the internal line buffer fInput.
+/// Reusing one Tokens object for subsequent lines recycles fInput, so
+/// tokenizing does not allocate once the buffer has grown to the line length.
+////////////////////////////////////////////////////////////////////////////////
 struct Tokens
 {
   std::string fInput;
-  Delimiter   fDelimiters;
-  Tokenizer   fTokenizer;
-  TokenIter   fTokenIter;
+  const char* fCurrent;
+  const char* fEnd;
+  bool        fIsDelimiter[256];
+
+  explicit Tokens(const std::string& delimiters)
+  : fInput()
+  , fCurrent(NULL)
+  , fEnd(NULL)
+  {
+    this->SetDelimiters(delimiters);
+  }
+
   Tokens(const std::string& input,
          const std::string& delimiters)
   : fInput(input)
-  , fDelimiters(delimiters.c_str())
-  , fTokenizer(this->fInput, this->fDelimiters)
-  , fTokenIter(this->fTokenizer.begin())
-  {}
+  , fCurrent(NULL)
+  , fEnd(NULL)
+  {
+    this->SetDelimiters(delimiters);
+    this->Assign(this->fInput.data(),
+                 this->fInput.data() + this->fInput.size());
+  }
+
+  Tokens(const Tokens& other)
+  : fInput(other.fInput)
+  , fCurrent(NULL)
+  , fEnd(NULL)
+  {
+    std::memcpy(this->fIsDelimiter, other.fIsDelimiter,
+                sizeof(this->fIsDelimiter));
+    this->Rebase(other);
+  }
+
+  Tokens& operator=(const Tokens& other)
+  {
+    if (this != &other)
+    {
+      this->fInput = other.fInput;
+      std::memcpy(this->fIsDelimiter, other.fIsDelimiter,
+                  sizeof(this->fIsDelimiter));
+      this->Rebase(other);
+    }
+    return *this;
+  }
+
+  void Assign(const char* begin, const char* end)
+  {
+    this->fCurrent = begin;
+    this->fEnd = end;
+  }
+
+private:
+  void SetDelimiters(const std::string& delimiters)
+  {
+    std::memset(this->fIsDelimiter, 0, sizeof(this->fIsDelimiter));
+    for (std::string::size_type i = 0; i < delimiters.size(); ++i)
+    {
+      this->fIsDelimiter[static_cast<unsigned char>(delimiters[i])] = true;
+    }
+  }
+
+  // views into the other object's line buffer have to be moved to our copy
+  void Rebase(const Tokens& other)
+  {
+    const char* otherBegin = other.fInput.data();
+    const char* otherEnd = otherBegin + other.fInput.size();
+    if (other.fCurrent >= otherBegin && other.fEnd <= otherEnd &&
+        other.fCurrent != NULL)
+    {
+      this->fCurrent = this->fInput.data() + (other.fCurrent - otherBegin);
+      this->fEnd = this->fInput.data() + (other.fEnd - otherBegin);
+    }
+    else
+    {
+      this->fCurrent = other.fCurrent;
+      this->fEnd = other.fEnd;
+    }
+  }
 };
 
 template <typename ReturnType>
@@ -89,11 +185,289 @@ ReturnType Line(std::ifstream& inputStream);
 io::ReaderTools::Tokens Line(std::ifstream& inputStream,
                              const std::string& delimiters);
 
+void Line(std::ifstream& inputStream, io::ReaderTools::Tokens* pTokens);
+
+template <typename ReturnType>
+ReturnType Line(io::MappedFile& inputFile);
+
+io::ReaderTools::Tokens Line(io::MappedFile& inputFile,
+                             const std::string& delimiters);
+
+void Line(io::MappedFile& inputFile, io::ReaderTools::Tokens* pTokens);
+
 template <typename ReturnType>
 ReturnType Token(io::ReaderTools::Tokens& tokens);
 
+template <typename ReturnType>
+ReturnType Parse(const char* begin, const char* end);
+
 std::string NonCommentLine(std::ifstream& inputStream);
 
+bool NonCommentLine(std::ifstream& inputStream,
+                    std::string* pLine,
+                    const char** pBegin,
+                    const char** pEnd);
+
+bool NonCommentLine(io::MappedFile& inputFile,
+                    const char** pBegin,
+                    const char** pEnd);
+
+bool NonCommentLine(const char** pPosition,
+                    const char* end,
+                    const char** pBegin,
+                    const char** pEnd);
+
+void SkipLine(io::MappedFile& inputFile);
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Whitespace as understood by std::isspace in the "C" locale
+////////////////////////////////////////////////////////////////////////////////
+inline
+bool
+IsSpace
+(char c)
+{
+  return (c == ' ' || c == '\t' || c == '\n' ||
+          c == '\r' || c == '\v' || c == '\f');
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reports a malformed or missing token the same way boost::lexical_cast did.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ReturnType>
+inline
+void
+ThrowBadToken
+()
+{
+  throw boost::bad_lexical_cast(typeid(std::string), typeid(ReturnType));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+inline
+bool
+NextToken
+(io::ReaderTools::Tokens& tokens,
+ const char** pBegin,
+ const char** pEnd)
+{
+  const char* current = tokens.fCurrent;
+  const char* const end = tokens.fEnd;
+  while (current != end &&
+         tokens.fIsDelimiter[static_cast<unsigned char>(*current)])
+  {
+    ++current;
+  }
+  *pBegin = current;
+  while (current != end &&
+         !tokens.fIsDelimiter[static_cast<unsigned char>(*current)])
+  {
+    ++current;
+  }
+  *pEnd = current;
+  tokens.fCurrent = current;
+  return (*pBegin != *pEnd);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Splits [begin, end) at blanks (space, tab, carriage return) into fields.
+/// Begin and end of field i are stored in pBounds[2i] and pBounds[2i + 1].
+/// Returns the number of fields, maxFields + 1 if there are more than
+/// maxFields. Where SSE2 is available, blanks are located 16 bytes at a time
+/// and only the boundaries between blanks and fields are visited.
+////////////////////////////////////////////////////////////////////////////////
+inline
+std::size_t
+SplitFields
+(const char* begin,
+ const char* end,
+ std::size_t maxFields,
+ const char** pBounds)
+{
+  const std::size_t maxBounds = 2u * maxFields;
+  std::size_t numBounds = 0u;
+  bool isInField = false;
+  const char* position = begin;
+
+#ifdef AVIGLE__IO__HAS_SSE2_SPLIT
+  const __m128i spaces = _mm_set1_epi8(' ');
+  const __m128i tabs = _mm_set1_epi8('\t');
+  const __m128i returns = _mm_set1_epi8('\r');
+  for (; end - position >= 16; position += 16)
+  {
+    const __m128i block =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+    const __m128i isBlank =
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, spaces),
+                                _mm_cmpeq_epi8(block, tabs)),
+                   _mm_cmpeq_epi8(block, returns));
+    const unsigned int fieldMask =
+      ~static_cast<unsigned int>(_mm_movemask_epi8(isBlank)) & 0xFFFFu;
+
+    // bits where a byte differs from its predecessor begin or end a field
+    unsigned int changes =
+      (fieldMask ^ ((fieldMask << 1) | (isInField ? 1u : 0u))) & 0xFFFFu;
+    for (; changes != 0u; changes &= changes - 1u)
+    {
+      if (numBounds == maxBounds)
+      {
+        return maxFields + 1u;
+      }
+      pBounds[numBounds++] = position + __builtin_ctz(changes);
+    }
+    isInField = ((fieldMask & 0x8000u) != 0u);
+  }
+#endif
+
+  for (; position != end; ++position)
+  {
+    const bool isBlank =
+      (*position == ' ' || *position == '\t' || *position == '\r');
+    if (isBlank == isInField)
+    {
+      if (numBounds == maxBounds)
+      {
+        return maxFields + 1u;
+      }
+      pBounds[numBounds++] = position;
+      isInField = !isInField;
+    }
+  }
+  if (isInField)
+  {
+    pBounds[numBounds++] = end;
+  }
+  return numBounds / 2u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Locale-independent conversion of unsigned integers.
+////////////////////////////////////////////////////////////////////////////////
+template <>
+inline
+unsigned int
+Parse<unsigned int>
+(const char* begin, const char* end)
+{
+  if (begin != end && *begin == '+')
+  {
+    ++begin;
+  }
+  if (begin == end)
+  {
+    io::ReaderTools::ThrowBadToken<unsigned int>();
+  }
+
+  const unsigned int maxValue = std::numeric_limits<unsigned int>::max();
+  unsigned int value = 0u;
+  for (; begin != end; ++begin)
+  {
+    const unsigned int digit =
+      static_cast<unsigned int>(static_cast<unsigned char>(*begin) - '0');
+    if (digit > 9u || value > (maxValue - digit) / 10u)
+    {
+      io::ReaderTools::ThrowBadToken<unsigned int>();
+    }
+    value = value * 10u + digit;
+  }
+  return value;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Locale-independent conversion of signed integers.
+////////////////////////////////////////////////////////////////////////////////
+template <>
+inline
+int
+Parse<int>
+(const char* begin, const char* end)
+{
+  const bool isNegative = (begin != end && *begin == '-');
+  if (isNegative)
+  {
+    ++begin;
+    if (begin != end && *begin == '+')
+    {
+      io::ReaderTools::ThrowBadToken<int>();
+    }
+  }
+
+  const unsigned int magnitude =
+    io::ReaderTools::Parse<unsigned int>(begin, end);
+  const unsigned int maxMagnitude =
+    static_cast<unsigned int>(std::numeric_limits<int>::max()) +
+    (isNegative ? 1u : 0u);
+  if (magnitude > maxMagnitude)
+  {
+    io::ReaderTools::ThrowBadToken<int>();
+  }
+  return isNegative ?
+    -static_cast<int>(magnitude - 1u) - 1 : static_cast<int>(magnitude);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Locale-independent conversion of floating point numbers.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+inline
+FloatType
+Parse
+(const char* begin, const char* end)
+{
+  // boost::lexical_cast accepted an explicit sign, std::from_chars does not
+  if (begin != end && *begin == '+')
+  {
+    ++begin;
+  }
+
+  FloatType value = static_cast<FloatType>(0.0);
+#ifdef AVIGLE__IO__HAS_CHARCONV
+  const std::from_chars_result result = std::from_chars(begin, end, value);
+  if (result.ec != std::errc() || result.ptr != end || begin == end)
+  {
+    io::ReaderTools::ThrowBadToken<FloatType>();
+  }
+#else
+  namespace qi = boost::spirit::qi;
+  if (!qi::parse(begin, end, qi::real_parser<FloatType>(), value) ||
+      begin != end)
+  {
+    io::ReaderTools::ThrowBadToken<FloatType>();
+  }
+#endif
+  return value;
+}
+
+
 
 
 
@@ -103,10 +477,10 @@ std::string NonCommentLine(std::ifstream& inputStream);
 template <>
 inline
 std::string
-Line<std::string>
-(std::ifstream& inputStream)
+Parse<std::string>
+(const char* begin, const char* end)
 {
-  return io::ReaderTools::NonCommentLine(inputStream);
+  return std::string(begin, end);
 }
 
 
@@ -118,14 +492,11 @@ Line<std::string>
 ////////////////////////////////////////////////////////////////////////////////
 template <>
 inline
-unsigned int
-Line<unsigned int>
+std::string
+Line<std::string>
 (std::ifstream& inputStream)
 {
-  const unsigned int retVal =
-    boost::lexical_cast<unsigned int>(
-      io::ReaderTools::NonCommentLine(inputStream));
-  return retVal;
+  return io::ReaderTools::NonCommentLine(inputStream);
 }
 
 
@@ -135,16 +506,21 @@ Line<unsigned int>
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////
-template <typename FloatType>
+template <typename ReturnType>
 inline
-FloatType
+ReturnType
 Line
 (std::ifstream& inputStream)
 {
-  const FloatType retVal =
-    boost::lexical_cast<FloatType>(
-      io::ReaderTools::NonCommentLine(inputStream));
-  return retVal;
+  std::string inputLine;
+  const char* begin = NULL;
+  const char* end = NULL;
+  io::ReaderTools::NonCommentLine(inputStream, &inputLine, &begin, &end);
+  while (end != begin && io::ReaderTools::IsSpace(*(end - 1)))
+  {
+    --end;
+  }
+  return io::ReaderTools::Parse<ReturnType>(begin, end);
 }
 
 
@@ -177,7 +553,28 @@ Line
 (std::ifstream& inputStream,
  const std::string& delimiters)
 {
-  return Tokens(io::ReaderTools::NonCommentLine(inputStream), delimiters);
+  io::ReaderTools::Tokens tokens(delimiters);
+  io::ReaderTools::Line(inputStream, &tokens);
+  return tokens;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the next non-comment line into the line buffer of the given tokens.
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+Line
+(std::ifstream& inputStream,
+ io::ReaderTools::Tokens* pTokens)
+{
+  const char* begin = NULL;
+  const char* end = NULL;
+  io::ReaderTools::NonCommentLine(inputStream, &pTokens->fInput, &begin, &end);
+  pTokens->Assign(begin, end);
 }
 
 
@@ -187,13 +584,20 @@ Line
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////
-template <>
+template <typename ReturnType>
 inline
-std::string
-Token<std::string>
-(io::ReaderTools::Tokens& tokens)
+ReturnType
+Line
+(io::MappedFile& inputFile)
 {
-  return *(tokens.fTokenIter++);
+  const char* begin = NULL;
+  const char* end = NULL;
+  io::ReaderTools::NonCommentLine(inputFile, &begin, &end);
+  while (end != begin && io::ReaderTools::IsSpace(*(end - 1)))
+  {
+    --end;
+  }
+  return io::ReaderTools::Parse<ReturnType>(begin, end);
 }
 
 
@@ -205,13 +609,49 @@ Token<std::string>
 ////////////////////////////////////////////////////////////////////////////////
 template <>
 inline
-unsigned int
-Token<unsigned int>
-(io::ReaderTools::Tokens& tokens)
+io::ReaderTools::Unused
+Line<io::ReaderTools::Unused>
+(io::MappedFile& inputFile)
+{
+  io::ReaderTools::SkipLine(inputFile);
+  return;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// The tokens view the mapped file directly, nothing is copied.
+////////////////////////////////////////////////////////////////////////////////
+inline
+io::ReaderTools::Tokens
+Line
+(io::MappedFile& inputFile,
+ const std::string& delimiters)
+{
+  io::ReaderTools::Tokens tokens(delimiters);
+  io::ReaderTools::Line(inputFile, &tokens);
+  return tokens;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// The tokens view the mapped file directly, nothing is copied.
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+Line
+(io::MappedFile& inputFile,
+ io::ReaderTools::Tokens* pTokens)
 {
-  const unsigned int retVal =
-    boost::lexical_cast<unsigned int>(*(tokens.fTokenIter++));
-  return retVal;
+  const char* begin = NULL;
+  const char* end = NULL;
+  io::ReaderTools::NonCommentLine(inputFile, &begin, &end);
+  pTokens->Assign(begin, end);
 }
 
 
@@ -221,15 +661,19 @@ Token<unsigned int>
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////
-template <typename FloatType>
+template <typename ReturnType>
 inline
-FloatType
+ReturnType
 Token
 (io::ReaderTools::Tokens& tokens)
 {
-  const FloatType retVal =
-    boost::lexical_cast<FloatType>(*(tokens.fTokenIter++));
-  return retVal;
+  const char* begin = NULL;
+  const char* end = NULL;
+  if (!io::ReaderTools::NextToken(tokens, &begin, &end))
+  {
+    io::ReaderTools::ThrowBadToken<ReturnType>();
+  }
+  return io::ReaderTools::Parse<ReturnType>(begin, end);
 }
 
 
@@ -245,7 +689,9 @@ io::ReaderTools::Unused
 Token<io::ReaderTools::Unused>
 (io::ReaderTools::Tokens& tokens)
 {
-  ++tokens.fTokenIter;
+  const char* begin = NULL;
+  const char* end = NULL;
+  io::ReaderTools::NextToken(tokens, &begin, &end);
   return;
 }
 
@@ -267,12 +713,177 @@ NonCommentLine
     std::getline(inputStream, inputLine);
     boost::algorithm::trim_left(inputLine);
   }
-  while ((inputLine.size() == 0) || (inputLine.c_str()[0] == '#'));
+  while (inputStream &&
+         ((inputLine.size() == 0) || (inputLine.c_str()[0] == '#')));
 
   return inputLine;
 }
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the next non-comment line into *pLine, reusing its storage.
+/// [*pBegin, *pEnd) is the line without leading whitespace.
+////////////////////////////////////////////////////////////////////////////////
+inline
+bool
+NonCommentLine
+(std::ifstream& inputStream,
+ std::string* pLine,
+ const char** pBegin,
+ const char** pEnd)
+{
+  while (std::getline(inputStream, *pLine))
+  {
+    const char* begin = pLine->data();
+    const char* const end = begin + pLine->size();
+    while (begin != end && io::ReaderTools::IsSpace(*begin))
+    {
+      ++begin;
+    }
+    if (begin != end && *begin != '#')
+    {
+      *pBegin = begin;
+      *pEnd = end;
+      return true;
+    }
+  }
+
+  *pBegin = pLine->data();
+  *pEnd = pLine->data();
+  return false;
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Advances *pPosition past the next non-comment line before end.
+/// [*pBegin, *pEnd) is that line without leading whitespace and without the
+/// line break.
+////////////////////////////////////////////////////////////////////////////////
+inline
+bool
+NonCommentLine
+(const char** pPosition,
+ const char* end,
+ const char** pBegin,
+ const char** pEnd)
+{
+  const char* position = *pPosition;
+  while (position != end)
+  {
+    const char* lineEnd = static_cast<const char*>(
+      std::memchr(position, '\n', static_cast<std::size_t>(end - position)));
+    const char* const next = (lineEnd == NULL) ? end : lineEnd + 1;
+    if (lineEnd == NULL)
+    {
+      lineEnd = end;
+    }
+
+    while (position != lineEnd && io::ReaderTools::IsSpace(*position))
+    {
+      ++position;
+    }
+    if (position != lineEnd && *position != '#')
+    {
+      *pBegin = position;
+      *pEnd = lineEnd;
+      *pPosition = next;
+      return true;
+    }
+    position = next;
+  }
+
+  *pPosition = end;
+  *pBegin = end;
+  *pEnd = end;
+  return false;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Advances the read position of the mapped file to the next non-comment
+/// line.
+////////////////////////////////////////////////////////////////////////////////
+inline
+bool
+NonCommentLine
+(io::MappedFile& inputFile,
+ const char** pBegin,
+ const char** pEnd)
+{
+  const char* position = inputFile.GetPosition();
+  const bool found = io::ReaderTools::NonCommentLine(
+    &position, inputFile.GetEnd(), pBegin, pEnd);
+  inputFile.SetPosition(position);
+  return found;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skips the remainder of the current line, comment or not.
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+SkipLine
+(io::MappedFile& inputFile)
+{
+  const char* const position = inputFile.GetPosition();
+  const char* const end = inputFile.GetEnd();
+  if (position == end)
+  {
+    return;
+  }
+  const char* const lineEnd = static_cast<const char*>(
+    std::memchr(position, '\n', static_cast<std::size_t>(end - position)));
+  inputFile.SetPosition((lineEnd == NULL) ? end : lineEnd + 1);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the number of patches announced in the header of a PMVS .patch
+/// file without reading any further, 0 if the header cannot be read.
+////////////////////////////////////////////////////////////////////////////////
+inline
+unsigned int
+CountPatches
+(const std::string& fileName)
+{
+  io::MappedFile patchesFile(fileName);
+  if (!patchesFile.IsOpen())
+  {
+    return 0u;
+  }
+
+  try
+  {
+    if (io::ReaderTools::Line<std::string>(patchesFile).compare("PATCHES") != 0)
+    {
+      return 0u;
+    }
+    return io::ReaderTools::Line<unsigned int>(patchesFile);
+  }
+  catch (const boost::bad_lexical_cast&)
+  {
+    return 0u;
+  }
+}
+
+
 } // namespace ReaderTools
 
 
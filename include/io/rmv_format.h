@@ -0,0 +1,281 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__RMV_FORMAT_H_
+#define AVIGLE__IO__RMV_FORMAT_H_
+
+
+#include <cstddef>
+#include <cstring>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <io/io_api.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Layout of binary RMV files (RMV_2).
+///
+/// A file starts with the line "RMV_2", padded with zeros to 8 bytes, and a
+/// fixed header (see Header). The header is followed by sections, each
+/// starting at a multiple of kSectionAlignment bytes:
+///   - textures: one record per texture (see AppendTexture)
+///   - positions, colours: three scalars per point
+///   - confidences: one scalar per point
+///   - tex coord offsets: numPoints + 1 uint64, the tex coords of point i
+///     are the entries [offsets[i], offsets[i + 1]) of the next sections
+///   - tex coord ids: one uint32 per tex coord
+///   - tex coords: two scalars (u, v) per tex coord
+/// All values are little endian. Scalars are float32 or float64 as given by
+/// the header.
+////////////////////////////////////////////////////////////////////////////////
+namespace RmvFormat
+{
+
+const std::size_t kMagicSize = 8u;
+const char kMagic[kMagicSize] = { 'R', 'M', 'V', '_', '2', '\n', '\0', '\0' };
+
+const std::size_t kSectionAlignment = 64u;
+
+enum ScalarType
+{
+  kScalarTypeFloat32 = 4,
+  kScalarTypeFloat64 = 8
+};
+
+struct Header
+{
+  boost::uint32_t fScalarType;
+  boost::uint64_t fNumTextures;
+  boost::uint64_t fNumPoints;
+  boost::uint64_t fNumTexCoords;
+  double fBoundingBoxMin[3];
+  double fBoundingBoxMax[3];
+  boost::uint64_t fTexturesOffset;
+  boost::uint64_t fTexturesSize;
+  boost::uint64_t fPositionsOffset;
+  boost::uint64_t fColoursOffset;
+  boost::uint64_t fConfidencesOffset;
+  boost::uint64_t fTexCoordOffsetsOffset;
+  boost::uint64_t fTexCoordIdsOffset;
+  boost::uint64_t fTexCoordsOffset;
+  boost::uint64_t fFileSize;
+};  // struct
+
+/// Size of magic and header in the file.
+const std::size_t kHeaderSize = kMagicSize + 2u * 4u + 3u * 8u + 6u * 8u +
+                                9u * 8u;
+
+struct TextureRecord
+{
+  unsigned int fId;
+  std::string fFileName;
+  unsigned int fWidth;
+  unsigned int fHeight;
+  double fPosition[3];
+  double fDirection[3];
+};  // struct
+
+inline std::size_t AlignOffset(std::size_t offset)
+{
+  return ((offset + kSectionAlignment - 1u) / kSectionAlignment) *
+    kSectionAlignment;
+}
+
+IO_API void ComputeLayout(Header* pHeader);
+IO_API void WriteHeader(const Header& header, char* pTarget);
+IO_API bool ReadHeader(const char* begin, const char* end, Header* pHeader);
+
+IO_API void AppendTexture(const TextureRecord& texture,
+                          std::vector<char>* pSection);
+IO_API const char* ReadTexture(const char* position,
+                               const char* end,
+                               TextureRecord* pTexture);
+
+
+
+inline void StoreLittle(boost::uint32_t value, char* pTarget)
+{
+  boost::endian::native_to_little_inplace(value);
+  std::memcpy(pTarget, &value, sizeof(value));
+}
+
+inline void StoreLittle(boost::uint64_t value, char* pTarget)
+{
+  boost::endian::native_to_little_inplace(value);
+  std::memcpy(pTarget, &value, sizeof(value));
+}
+
+inline void StoreLittle(float value, char* pTarget)
+{
+  boost::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  StoreLittle(bits, pTarget);
+}
+
+inline void StoreLittle(double value, char* pTarget)
+{
+  boost::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  StoreLittle(bits, pTarget);
+}
+
+inline void LoadLittle(const char* pSource, boost::uint32_t* pValue)
+{
+  std::memcpy(pValue, pSource, sizeof(*pValue));
+  boost::endian::little_to_native_inplace(*pValue);
+}
+
+inline void LoadLittle(const char* pSource, boost::uint64_t* pValue)
+{
+  std::memcpy(pValue, pSource, sizeof(*pValue));
+  boost::endian::little_to_native_inplace(*pValue);
+}
+
+inline void LoadLittle(const char* pSource, float* pValue)
+{
+  boost::uint32_t bits;
+  LoadLittle(pSource, &bits);
+  std::memcpy(pValue, &bits, sizeof(bits));
+}
+
+inline void LoadLittle(const char* pSource, double* pValue)
+{
+  boost::uint64_t bits;
+  LoadLittle(pSource, &bits);
+  std::memcpy(pValue, &bits, sizeof(bits));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes values as one little-endian column. Advances *pPosition by the
+/// number of bytes written.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ValueType>
+void
+WriteColumn
+(const std::vector<ValueType>& values,
+ std::ostream& output,
+ std::size_t* pPosition)
+{
+  const std::size_t numBytes = values.size() * sizeof(ValueType);
+  if (numBytes == 0u)
+  {
+    return;
+  }
+  if (boost::endian::order::native == boost::endian::order::little)
+  {
+    output.write(reinterpret_cast<const char*>(&values[0]), numBytes);
+  }
+  else
+  {
+    std::vector<char> buffer(numBytes);
+    for (std::size_t value = 0u; value < values.size(); ++value)
+    {
+      StoreLittle(values[value], &buffer[value * sizeof(ValueType)]);
+    }
+    output.write(&buffer[0], numBytes);
+  }
+  *pPosition += numBytes;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Appends count scalars stored as scalarType at source to a vector.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+AppendScalars
+(const char* source,
+ std::size_t count,
+ boost::uint32_t scalarType,
+ std::vector<FloatType>* pTarget)
+{
+  const std::size_t first = pTarget->size();
+  pTarget->resize(first + count);
+  if (count == 0u)
+  {
+    return;
+  }
+  FloatType* target = &(*pTarget)[first];
+  if (scalarType == kScalarTypeFloat32)
+  {
+    float value;
+    for (std::size_t scalar = 0u; scalar < count; ++scalar)
+    {
+      LoadLittle(source + scalar * sizeof(float), &value);
+      target[scalar] = static_cast<FloatType>(value);
+    }
+  }
+  else
+  {
+    double value;
+    for (std::size_t scalar = 0u; scalar < count; ++scalar)
+    {
+      LoadLittle(source + scalar * sizeof(double), &value);
+      target[scalar] = static_cast<FloatType>(value);
+    }
+  }
+}
+
+} // namespace RmvFormat
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__RMV_FORMAT_H_
@@ -45,16 +45,22 @@
 #define AVIGLE__IO__RMV_READER_H_
 
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
 
 #include <boost/filesystem.hpp>
-#include <boost/tokenizer.hpp>
 
+#include <io/dataset_info.h>
 #include <io/io_api.h>
 #include <io/input_adapter_interface.h>
+#include <io/load_options.h>
+#include <io/mapped_file.h>
+#include <io/parallel_tools.h>
+#include <io/point_batch.h>
 #include <io/reader_tools.h>
+#include <io/rmv_format.h>
 
 
 namespace io
@@ -71,17 +77,35 @@ private:
   enum RmvVersion
   {
     kRmvVersion010 = 1,
+    kRmvVersion020 = 2,
     kRmvVersionInvalid
   };
 
-  RmvReader(const std::string& fileName);
+  RmvReader(const std::string& fileName,
+            const io::LoadOptions& loadOptions = io::LoadOptions());
   ~RmvReader();
 
+  void Probe(io::DatasetInfo* pInfo);
+
   template <typename FloatType>
   void Load(InputAdapterInterface<FloatType>* pInputAdapter);
 
+  template <typename FloatType>
+  void LoadVersion2(const io::MappedFile& inputFile,
+                    InputAdapterInterface<FloatType>* pInputAdapter);
+
+  template <typename FloatType>
+  static void ParsePoint(io::ReaderTools::Tokens& pointTokens,
+                         io::PointBatch<FloatType>* pBatch);
+
+  template <typename FloatType>
+  static void ParsePoints(const char* begin,
+                          const char* end,
+                          io::PointBatch<FloatType>* pBatch);
+
   boost::filesystem::path fInputPath;
   RmvVersion fVersion;
+  io::LoadOptions fLoadOptions;
 };  // class
 
 
@@ -99,8 +123,8 @@ RmvReader::Load
   namespace iort = io::ReaderTools;
 
   // open
-  std::ifstream inputStream(this->fInputPath.c_str());
-  if (!inputStream.is_open())
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
   {
     std::cerr << "Could not open input file " << this->fInputPath << "!";
     std::cerr << std::endl;
@@ -109,11 +133,17 @@ RmvReader::Load
   }
 
   // determine version
-  const std::string version(iort::Line<std::string>(inputStream));
+  const std::string version(iort::Line<std::string>(inputFile));
   if(version.compare("RMV_1") == 0)
   {
     this->fVersion = io::RmvReader::kRmvVersion010;
   }
+  else if(version.compare("RMV_2") == 0)
+  {
+    this->fVersion = io::RmvReader::kRmvVersion020;
+    this->LoadVersion2(inputFile, pInputAdapter);
+    return;
+  }
   else
   {
     std::cerr << "Input file " << this->fInputPath << " not a valid RMV file!";
@@ -123,10 +153,12 @@ RmvReader::Load
   }
 
   // TEXTURES
-  const unsigned int numOfTextures = iort::Line<unsigned int>(inputStream);
+  const unsigned int numOfTextures = iort::Line<unsigned int>(inputFile);
+  pInputAdapter->OnBeginTextures(numOfTextures);
+  iort::Tokens textureTokens(";");
   for (unsigned int texNum = 0; texNum < numOfTextures; ++texNum)
   {
-    iort::Tokens textureTokens(iort::Line<std::string>(inputStream), ";");
+    iort::Line(inputFile, &textureTokens);
     const unsigned int texId = iort::Token<unsigned int>(textureTokens);
     const std::string texFileName(iort::Token<std::string>(textureTokens));
     const unsigned int texWidth = iort::Token<unsigned int>(textureTokens);
@@ -165,39 +197,252 @@ RmvReader::Load
   }
 
   // POINTS
-  const unsigned int numOfPoints = iort::Line<unsigned int>(inputStream);
-  for (unsigned int pointNum = 0; pointNum < numOfPoints; ++pointNum)
+  const unsigned int numOfPoints = iort::Line<unsigned int>(inputFile);
+  pInputAdapter->OnBeginPoints(numOfPoints);
+  if (this->fLoadOptions.fNumThreads != 1u)
+  {
+    io::ParallelChunkParser<FloatType> parser(
+      &io::RmvReader::ParsePoints<FloatType>,
+      this->fLoadOptions.fNumThreads,
+      this->fLoadOptions.fPreserveOrder);
+    const std::size_t numOfLoadedPoints = parser.Run(
+      io::ParallelTools::SplitLines(inputFile.GetPosition(),
+                                    inputFile.GetEnd()),
+      numOfPoints,
+      pInputAdapter);
+    if (numOfLoadedPoints != numOfPoints)
+    {
+      std::cerr << "Input file " << this->fInputPath << " is truncated!";
+      std::cerr << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  else
   {
-    iort::Tokens pointTokens(iort::Line<std::string>(inputStream), ";");
-    const FloatType positionX = iort::Token<FloatType>(pointTokens);
-    const FloatType positionY = iort::Token<FloatType>(pointTokens);
-    const FloatType positionZ = iort::Token<FloatType>(pointTokens);
-    const FloatType colourR = iort::Token<FloatType>(pointTokens);
-    const FloatType colourG = iort::Token<FloatType>(pointTokens);
-    const FloatType colourB = iort::Token<FloatType>(pointTokens);
-
-    pInputAdapter->OnBeginPoint();
-    pInputAdapter->OnPointPosition(positionX, positionY, positionZ);
-    pInputAdapter->OnPointColour(colourR, colourG, colourB);
-
-    iort::Token<iort::Unused>(pointTokens); // confidence --> not yet used
-
-    // tex coords per point
-    const unsigned int numCoords = iort::Token<unsigned int>(pointTokens);
-    for (unsigned int texCoord = 0; texCoord < numCoords; ++texCoord)
+    iort::Tokens pointTokens(";");
+    io::PointBatch<FloatType> batch;
+    for (unsigned int pointNum = 0; pointNum < numOfPoints; ++pointNum)
+    {
+      iort::Line(inputFile, &pointTokens);
+      RmvReader::ParsePoint(pointTokens, &batch);
+      if (batch.GetSize() == io::kPointBatchSize)
+      {
+        pInputAdapter->OnPointBatch(batch);
+        batch.Clear();
+      }
+    }
+    if (!batch.IsEmpty())
     {
-      const unsigned int texCoordId = iort::Token<unsigned int>(pointTokens);
-      const FloatType texCoordU = iort::Token<FloatType>(pointTokens);
-      const FloatType texCoordV = iort::Token<FloatType>(pointTokens);
+      pInputAdapter->OnPointBatch(batch);
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Loader for the binary RMV_2 format (see io::RmvFormat). Columns are
+/// copied into point batches without any parsing.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvReader::LoadVersion2
+(const io::MappedFile& inputFile,
+ InputAdapterInterface<FloatType>* pInputAdapter)
+{
+  namespace rf = io::RmvFormat;
 
-      pInputAdapter->OnPointTexCoord(texCoordId, texCoordU, texCoordV);
+  const char* const begin = inputFile.GetBegin();
+  rf::Header header;
+  if (!rf::ReadHeader(begin, inputFile.GetEnd(), &header))
+  {
+    std::cerr << "Input file " << this->fInputPath << " has an invalid header!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // TEXTURES
+  const char* texturePosition = begin + header.fTexturesOffset;
+  const char* const texturesEnd = texturePosition + header.fTexturesSize;
+  rf::TextureRecord texture;
+  pInputAdapter->OnBeginTextures(header.fNumTextures);
+  for (boost::uint64_t texNum = 0u; texNum < header.fNumTextures; ++texNum)
+  {
+    texturePosition = rf::ReadTexture(texturePosition, texturesEnd, &texture);
+    if (texturePosition == NULL)
+    {
+      std::cerr << "Input file " << this->fInputPath << " is corrupt!";
+      std::cerr << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
     }
-    pInputAdapter->OnEndPoint();
+
+    pInputAdapter->OnTexture(
+      texture.fId,   // id
+      boost::filesystem::absolute(                // file name
+        boost::filesystem::path(
+          texture.fFileName),
+          this->fInputPath.parent_path()).string(),
+      texture.fWidth, texture.fHeight,
+      static_cast<FloatType>(texture.fPosition[0]),
+      static_cast<FloatType>(texture.fPosition[1]),
+      static_cast<FloatType>(texture.fPosition[2]),
+      static_cast<FloatType>(texture.fDirection[0]),
+      static_cast<FloatType>(texture.fDirection[1]),
+      static_cast<FloatType>(texture.fDirection[2]),
+      static_cast<FloatType>(1.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(1.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(1.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0),
+      static_cast<FloatType>(0.0)
+    );
+  }
+
+  // POINTS
+  const std::size_t scalarSize = header.fScalarType;
+  const std::size_t numOfPoints = header.fNumPoints;
+  const std::size_t numOfTexCoords = header.fNumTexCoords;
+  pInputAdapter->OnBeginPoints(numOfPoints);
+  const char* const texCoordOffsets = begin + header.fTexCoordOffsetsOffset;
+
+  boost::uint64_t firstTexCoord = 0u;
+  rf::LoadLittle(texCoordOffsets, &firstTexCoord);
+
+  io::PointBatch<FloatType> batch;
+  for (std::size_t firstPoint = 0u;
+       firstPoint < numOfPoints;
+       firstPoint += io::kPointBatchSize)
+  {
+    const std::size_t numPoints =
+      std::min(io::kPointBatchSize, numOfPoints - firstPoint);
+
+    rf::AppendScalars(begin + header.fPositionsOffset +
+                        3u * firstPoint * scalarSize,
+                      3u * numPoints, header.fScalarType, &batch.fPositions);
+    rf::AppendScalars(begin + header.fColoursOffset +
+                        3u * firstPoint * scalarSize,
+                      3u * numPoints, header.fScalarType, &batch.fColours);
+
+    // offsets must not decrease and must stay within the tex coords
+    boost::uint64_t texCoord = firstTexCoord;
+    for (std::size_t point = 1u; point <= numPoints; ++point)
+    {
+      boost::uint64_t nextTexCoord = 0u;
+      rf::LoadLittle(texCoordOffsets + 8u * (firstPoint + point),
+                     &nextTexCoord);
+      if (nextTexCoord < texCoord || nextTexCoord > numOfTexCoords)
+      {
+        std::cerr << "Input file " << this->fInputPath << " is corrupt!";
+        std::cerr << std::endl;
+        std::cerr << "Terminating." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      texCoord = nextTexCoord;
+      batch.fTexCoordOffsets.push_back(
+        static_cast<unsigned int>(texCoord - firstTexCoord));
+    }
+
+    const std::size_t numTexCoords =
+      static_cast<std::size_t>(texCoord - firstTexCoord);
+    const char* texCoordIds = begin + header.fTexCoordIdsOffset +
+      4u * static_cast<std::size_t>(firstTexCoord);
+    batch.fTexCoordIds.resize(numTexCoords);
+    for (std::size_t id = 0u; id < numTexCoords; ++id)
+    {
+      boost::uint32_t texCoordId;
+      rf::LoadLittle(texCoordIds + 4u * id, &texCoordId);
+      batch.fTexCoordIds[id] = texCoordId;
+    }
+    rf::AppendScalars(begin + header.fTexCoordsOffset +
+                        2u * static_cast<std::size_t>(firstTexCoord) *
+                        scalarSize,
+                      2u * numTexCoords, header.fScalarType,
+                      &batch.fTexCoords);
+
+    pInputAdapter->OnPointBatch(batch);
+    batch.Clear();
+    firstTexCoord = texCoord;
   }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses one line of the POINTS section.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvReader::ParsePoint
+(io::ReaderTools::Tokens& pointTokens,
+ io::PointBatch<FloatType>* pBatch)
+{
+  namespace iort = io::ReaderTools;
+
+  const FloatType positionX = iort::Token<FloatType>(pointTokens);
+  const FloatType positionY = iort::Token<FloatType>(pointTokens);
+  const FloatType positionZ = iort::Token<FloatType>(pointTokens);
+  const FloatType colourR = iort::Token<FloatType>(pointTokens);
+  const FloatType colourG = iort::Token<FloatType>(pointTokens);
+  const FloatType colourB = iort::Token<FloatType>(pointTokens);
+
+  pBatch->AddPosition(positionX, positionY, positionZ);
+  pBatch->AddColour(colourR, colourG, colourB);
+
+  iort::Token<iort::Unused>(pointTokens); // confidence --> not yet used
+
+  // tex coords per point
+  const unsigned int numCoords = iort::Token<unsigned int>(pointTokens);
+  for (unsigned int texCoord = 0; texCoord < numCoords; ++texCoord)
+  {
+    const unsigned int texCoordId = iort::Token<unsigned int>(pointTokens);
+    const FloatType texCoordU = iort::Token<FloatType>(pointTokens);
+    const FloatType texCoordV = iort::Token<FloatType>(pointTokens);
+
+    pBatch->AddTexCoord(texCoordId, texCoordU, texCoordV);
+  }
+  pBatch->EndPoint();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parses all point lines in [begin, end), used for chunks of the POINTS
+/// section when parsing in parallel.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvReader::ParsePoints
+(const char* begin,
+ const char* end,
+ io::PointBatch<FloatType>* pBatch)
+{
+  namespace iort = io::ReaderTools;
 
-  if (inputStream.is_open())
+  iort::Tokens pointTokens(";");
+  const char* position = begin;
+  const char* lineBegin = NULL;
+  const char* lineEnd = NULL;
+  while (iort::NonCommentLine(&position, end, &lineBegin, &lineEnd))
   {
-    inputStream.close();
+    pointTokens.Assign(lineBegin, lineEnd);
+    RmvReader::ParsePoint(pointTokens, pBatch);
   }
 }
 
@@ -0,0 +1,517 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__RMV_STREAM_ADAPTER_H_
+#define AVIGLE__IO__RMV_STREAM_ADAPTER_H_
+
+
+#include <cstddef>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <io/input_adapter_interface.h>
+#include <io/point_batch.h>
+#include <io/rmv_stream_writer.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Input adapter that writes everything it receives to an RMV_1 file, so
+/// InputData::Load() converts a data set without holding it in memory. The
+/// reader hands textures and point batches to a bounded queue, a writer
+/// thread formats them through an io::RmvStreamWriter, i.e. parsing and
+/// formatting overlap and at most queueCapacity batches are in flight.
+///
+/// Points without colour are written white and all confidences as zero,
+/// like PointCloudOutputAdapter does. Normals and the texture matrices are
+/// not part of RMV_1 and dropped.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+class RmvStreamAdapter : public io::InputAdapterInterface<FloatType>,
+                         private boost::noncopyable
+{
+public:
+  /// Number of batches queued by default.
+  static const std::size_t kDefaultQueueCapacity = 16u;
+
+  RmvStreamAdapter(const std::string& fileName,
+                   std::size_t queueCapacity = kDefaultQueueCapacity);
+  virtual ~RmvStreamAdapter();
+
+  /// Writes the remaining points, waits for the writer thread and completes
+  /// the file. Called by the destructor if necessary.
+  void Finish();
+
+  unsigned int GetNumTextures() const
+  {
+    return this->fWriter.GetNumTextures();
+  }
+  unsigned int GetNumPoints() const { return this->fWriter.GetNumPoints(); }
+
+  virtual void OnBeginPoint() {}
+  virtual void OnPointPosition(FloatType x, FloatType y, FloatType z);
+  virtual void OnPointNormal(FloatType /*x*/,
+                             FloatType /*y*/,
+                             FloatType /*z*/) {}
+  virtual void OnPointColour(FloatType r, FloatType g, FloatType b);
+  virtual void OnPointTexCoord(unsigned int id, FloatType u, FloatType v);
+  virtual void OnEndPoint();
+
+  virtual void OnPointBatch(const io::PointBatch<FloatType>& batch);
+  virtual bool AcceptsConcurrentBatches() const { return true; }
+
+  virtual void OnTexture(
+    unsigned int id,
+    const std::string& fileName,
+    unsigned int width, unsigned int height,
+    FloatType camPosX, FloatType camPosY, FloatType camPosZ,
+    FloatType camDirX, FloatType camDirY, FloatType camDirZ,
+    FloatType m11, FloatType m12, FloatType m13,
+    FloatType m21, FloatType m22, FloatType m23,
+    FloatType m31, FloatType m32, FloatType m33,
+    FloatType offsetX, FloatType offsetY, FloatType offsetZ,
+    FloatType offsetU, FloatType offsetV);
+
+private:
+  struct Item
+  {
+    enum Kind
+    {
+      kKindTexture = 0,
+      kKindPoints,
+      kKindEnd
+    };
+
+    Kind fKind;
+
+    unsigned int fTextureId;
+    std::string fTextureFileName;
+    unsigned int fTextureWidth;
+    unsigned int fTextureHeight;
+    FloatType fTexturePosition[3];
+    FloatType fTextureDirection[3];
+
+    io::PointBatch<FloatType> fPoints;
+  };
+
+  Item* AcquireItem();
+  void Enqueue(Item* pItem);
+  void EnqueuePoints(const io::PointBatch<FloatType>& batch);
+  void Write();
+
+  io::RmvStreamWriter fWriter;
+
+  boost::scoped_array<Item> fItems;
+  std::vector<Item*> fFreeItems;
+  std::deque<Item*> fQueue;
+  boost::mutex fMutex;
+  boost::condition_variable fItemFreed;
+  boost::condition_variable fItemQueued;
+
+  /// Points delivered one callback at a time.
+  io::PointBatch<FloatType> fPendingPoints;
+
+  boost::thread fThread;
+  bool fIsFinished;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+RmvStreamAdapter<FloatType>::RmvStreamAdapter
+(const std::string& fileName, std::size_t queueCapacity)
+: fWriter(fileName)
+, fItems()
+, fFreeItems()
+, fQueue()
+, fPendingPoints()
+, fThread()
+, fIsFinished(false)
+{
+  const std::size_t numItems = std::max<std::size_t>(queueCapacity, 1u);
+  this->fItems.reset(new Item[numItems]);
+  for (std::size_t item = 0u; item < numItems; ++item)
+  {
+    this->fFreeItems.push_back(&this->fItems[item]);
+  }
+  this->fThread =
+    boost::thread(boost::bind(&RmvStreamAdapter<FloatType>::Write, this));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+RmvStreamAdapter<FloatType>::~RmvStreamAdapter
+()
+{
+  if (!this->fIsFinished)
+  {
+    this->Finish();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::Finish
+()
+{
+  if (this->fIsFinished)
+  {
+    return;
+  }
+
+  if (!this->fPendingPoints.IsEmpty())
+  {
+    this->EnqueuePoints(this->fPendingPoints);
+    this->fPendingPoints.Clear();
+  }
+
+  Item* pItem = this->AcquireItem();
+  pItem->fKind = Item::kKindEnd;
+  this->Enqueue(pItem);
+
+  this->fThread.join();
+  this->fWriter.Finish();
+  this->fIsFinished = true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnPointPosition
+(FloatType x, FloatType y, FloatType z)
+{
+  this->fPendingPoints.AddPosition(x, y, z);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnPointColour
+(FloatType r, FloatType g, FloatType b)
+{
+  this->fPendingPoints.AddColour(r, g, b);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnPointTexCoord
+(unsigned int id, FloatType u, FloatType v)
+{
+  this->fPendingPoints.AddTexCoord(id, u, v);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Points without a colour get white, and all points a confidence of 0, so
+/// that every column holds one entry per point even if only some points of
+/// a batch were given a colour.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnEndPoint
+()
+{
+  this->fPendingPoints.EndPoint();
+  const std::size_t numPoints = this->fPendingPoints.GetSize();
+  this->fPendingPoints.fColours.resize(3u * numPoints,
+                                       static_cast<FloatType>(1.0));
+  this->fPendingPoints.fConfidences.resize(numPoints,
+                                           static_cast<FloatType>(0.0));
+  if (this->fPendingPoints.GetSize() == io::kPointBatchSize)
+  {
+    this->EnqueuePoints(this->fPendingPoints);
+    this->fPendingPoints.Clear();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// May be called from several reader threads at once.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnPointBatch
+(const io::PointBatch<FloatType>& batch)
+{
+  if (!batch.IsEmpty())
+  {
+    this->EnqueuePoints(batch);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::OnTexture
+(unsigned int id,
+ const std::string& fileName,
+ unsigned int width, unsigned int height,
+ FloatType camPosX, FloatType camPosY, FloatType camPosZ,
+ FloatType camDirX, FloatType camDirY, FloatType camDirZ,
+ FloatType /*m11*/, FloatType /*m12*/, FloatType /*m13*/,
+ FloatType /*m21*/, FloatType /*m22*/, FloatType /*m23*/,
+ FloatType /*m31*/, FloatType /*m32*/, FloatType /*m33*/,
+ FloatType /*offsetX*/, FloatType /*offsetY*/, FloatType /*offsetZ*/,
+ FloatType /*offsetU*/, FloatType /*offsetV*/)
+{
+  Item* pItem = this->AcquireItem();
+  pItem->fKind = Item::kKindTexture;
+  pItem->fTextureId = id;
+  pItem->fTextureFileName = fileName;
+  pItem->fTextureWidth = width;
+  pItem->fTextureHeight = height;
+  pItem->fTexturePosition[0] = camPosX;
+  pItem->fTexturePosition[1] = camPosY;
+  pItem->fTexturePosition[2] = camPosZ;
+  pItem->fTextureDirection[0] = camDirX;
+  pItem->fTextureDirection[1] = camDirY;
+  pItem->fTextureDirection[2] = camDirZ;
+  this->Enqueue(pItem);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Takes an unused item, waiting for the writer if the queue is full.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+typename RmvStreamAdapter<FloatType>::Item*
+RmvStreamAdapter<FloatType>::AcquireItem
+()
+{
+  boost::unique_lock<boost::mutex> lock(this->fMutex);
+  while (this->fFreeItems.empty())
+  {
+    this->fItemFreed.wait(lock);
+  }
+  Item* pItem = this->fFreeItems.back();
+  this->fFreeItems.pop_back();
+  return pItem;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::Enqueue
+(Item* pItem)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(this->fMutex);
+    this->fQueue.push_back(pItem);
+  }
+  this->fItemQueued.notify_one();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copies the batch into a queue item, outside the lock, and completes the
+/// colours and confidences the writer expects.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::EnqueuePoints
+(const io::PointBatch<FloatType>& batch)
+{
+  Item* pItem = this->AcquireItem();
+  pItem->fKind = Item::kKindPoints;
+
+  io::PointBatch<FloatType>& points = pItem->fPoints;
+  points.fPositions.assign(batch.fPositions.begin(), batch.fPositions.end());
+  points.fNormals.clear();
+  if (batch.HasColours())
+  {
+    points.fColours.assign(batch.fColours.begin(), batch.fColours.end());
+  }
+  else
+  {
+    points.fColours.assign(3u * batch.GetSize(), static_cast<FloatType>(1.0));
+  }
+  if (batch.HasConfidences())
+  {
+    points.fConfidences.assign(batch.fConfidences.begin(),
+                               batch.fConfidences.end());
+  }
+  else
+  {
+    points.fConfidences.assign(batch.GetSize(), static_cast<FloatType>(0.0));
+  }
+  points.fTexCoordOffsets.assign(batch.fTexCoordOffsets.begin(),
+                                 batch.fTexCoordOffsets.end());
+  points.fTexCoordIds.assign(batch.fTexCoordIds.begin(),
+                             batch.fTexCoordIds.end());
+  points.fTexCoords.assign(batch.fTexCoords.begin(), batch.fTexCoords.end());
+
+  this->Enqueue(pItem);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Body of the writer thread. Items are written outside the lock, so the
+/// readers keep filling the queue meanwhile.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamAdapter<FloatType>::Write
+()
+{
+  for (;;)
+  {
+    Item* pItem = NULL;
+    {
+      boost::unique_lock<boost::mutex> lock(this->fMutex);
+      while (this->fQueue.empty())
+      {
+        this->fItemQueued.wait(lock);
+      }
+      pItem = this->fQueue.front();
+      this->fQueue.pop_front();
+    }
+
+    const bool isEnd = (pItem->fKind == Item::kKindEnd);
+    if (pItem->fKind == Item::kKindTexture)
+    {
+      this->fWriter.AddTexture(pItem->fTextureId,
+                               pItem->fTextureFileName,
+                               pItem->fTextureWidth,
+                               pItem->fTextureHeight,
+                               pItem->fTexturePosition,
+                               pItem->fTextureDirection);
+    }
+    else if (pItem->fKind == Item::kKindPoints)
+    {
+      this->fWriter.AddPointBatch(pItem->fPoints);
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(this->fMutex);
+      this->fFreeItems.push_back(pItem);
+    }
+    this->fItemFreed.notify_one();
+
+    if (isEnd)
+    {
+      return;
+    }
+  }
+}
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__RMV_STREAM_ADAPTER_H_
@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__RMV_STREAM_WRITER_H_
+#define AVIGLE__IO__RMV_STREAM_WRITER_H_
+
+
+#include <cstdlib>
+
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <io/io_api.h>
+#include <io/point_batch.h>
+#include <io/rmv_writer.h>
+#include <io/text_emitter.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes an RMV_1 file incrementally, for producers that do not know the
+/// number of textures and points in advance. The counts are written as
+/// fixed-width placeholders and filled in by Finish(); until then the file
+/// already holds every texture and point added and flushed so far.
+///
+/// The format requires all textures to precede the points, hence textures
+/// can no longer be added once the first point has been.
+////////////////////////////////////////////////////////////////////////////////
+class IO_API RmvStreamWriter : private boost::noncopyable
+{
+public:
+  RmvStreamWriter(const std::string& fileName);
+  ~RmvStreamWriter();
+
+  void BeginTextures();
+  template <typename FloatType>
+  void AddTexture(unsigned int id,
+                  const std::string& fileName,
+                  unsigned int width, unsigned int height,
+                  const FloatType* position,
+                  const FloatType* direction);
+
+  void BeginPoints();
+  template <typename FloatType>
+  void AddPoint(const FloatType* position,
+                const FloatType* colour,
+                FloatType confidence,
+                unsigned int numTexCoords = 0u,
+                const unsigned int* texIds = NULL,
+                const FloatType* texCoords = NULL);
+  template <typename FloatType>
+  void AddPointBatch(const io::PointBatch<FloatType>& batch);
+
+  unsigned int GetNumTextures() const { return this->fNumTextures; }
+  unsigned int GetNumPoints() const { return this->fNumPoints; }
+
+  void Flush();
+  void Finish();
+
+private:
+  enum State
+  {
+    kStateCreated = 0,
+    kStateTextures,
+    kStatePoints,
+    kStateFinished
+  };
+
+  /// Digits of the largest count (std::numeric_limits<unsigned int>::max()).
+  static const std::size_t kCountWidth = 10u;
+
+  void PutCountPlaceholder(std::streampos* pPosition);
+  void PatchCount(std::streampos position, unsigned int count);
+  void Fail(const std::string& message) const;
+
+  boost::filesystem::path fOutputPath;
+  io::TextEmitter fOut;
+  State fState;
+
+  std::streampos fNumTexturesPosition;
+  std::streampos fNumPointsPosition;
+  unsigned int fNumTextures;
+  unsigned int fNumPoints;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamWriter::AddTexture
+(unsigned int id,
+ const std::string& fileName,
+ unsigned int width, unsigned int height,
+ const FloatType* position,
+ const FloatType* direction)
+{
+  if (this->fState == kStateCreated)
+  {
+    this->BeginTextures();
+  }
+  if (this->fState != kStateTextures)
+  {
+    this->Fail("Cannot add textures after the points");
+  }
+
+  io::RmvWriter::PutTexture(
+    id, fileName, width, height, position, direction, &this->fOut);
+  ++this->fNumTextures;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamWriter::AddPoint
+(const FloatType* position,
+ const FloatType* colour,
+ FloatType confidence,
+ unsigned int numTexCoords,
+ const unsigned int* texIds,
+ const FloatType* texCoords)
+{
+  if (this->fState != kStatePoints)
+  {
+    this->BeginPoints();
+  }
+
+  io::RmvWriter::PutPoint(
+    position, colour, confidence, numTexCoords, &this->fOut);
+  for (unsigned int texCoord = 0u; texCoord < numTexCoords; ++texCoord)
+  {
+    io::RmvWriter::PutTextureCoordinate(texIds[texCoord],
+                                        texCoords[2u * texCoord],
+                                        texCoords[2u * texCoord + 1u],
+                                        &this->fOut);
+  }
+  this->fOut.Put('\n');
+  ++this->fNumPoints;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Adds a batch holding positions, colours and confidences of its points,
+/// e.g. one filled by OutputAdapterInterface::FetchPointBatch().
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvStreamWriter::AddPointBatch
+(const io::PointBatch<FloatType>& batch)
+{
+  if (this->fState != kStatePoints)
+  {
+    this->BeginPoints();
+  }
+
+  io::RmvWriter::FormatBatch(batch, &this->fOut);
+  this->fNumPoints += static_cast<unsigned int>(batch.GetSize());
+}
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__RMV_STREAM_WRITER_H_
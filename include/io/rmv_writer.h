@@ -45,15 +45,26 @@
 #define AVIGLE__IO__RMV_WRITER_H_
 
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <vector>
 
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/tokenizer.hpp>
 
 #include <io/io_api.h>
 #include <io/output_adapter_interface.h>
+#include <io/parallel_tools.h>
+#include <io/point_batch.h>
+#include <io/rmv_format.h>
+#include <io/text_emitter.h>
+#include <io/work_stealing_pool.h>
 
 
 namespace io
@@ -64,15 +75,22 @@ namespace io
 ////////////////////////////////////////////////////////////////////////////////
 class IO_API RmvWriter
 {
+  friend class InputData;
   friend class OutputData;
+  friend class RmvStreamWriter;
 
 private:
   enum RmvVersion
   {
-    kRmvVersion010 = 1
+    kRmvVersion010 = 1,
+    kRmvVersion020 = 2
   };
 
-  RmvWriter(const std::string& fileName, RmvVersion rmvVersion = kRmvVersion010);
+  /// numThreads limits the threads formatting RMV_1 points concurrently,
+  /// 0 meaning one per hardware thread.
+  RmvWriter(const std::string& fileName,
+            RmvVersion rmvVersion = kRmvVersion010,
+            unsigned int numThreads = 0u);
   ~RmvWriter();
 
   template <typename FloatType>
@@ -81,8 +99,62 @@ private:
   template <typename FloatType>
   void WriteVersion1(OutputAdapterInterface<FloatType>* pOutputAdapter);
 
+  template <typename FloatType>
+  void WriteVersion2(OutputAdapterInterface<FloatType>* pOutputAdapter);
+
+  template <typename FloatType>
+  static void PutTexture(unsigned int texId,
+                         const std::string& fileName,
+                         unsigned int width,
+                         unsigned int height,
+                         const FloatType* position,
+                         const FloatType* direction,
+                         io::TextEmitter* pOut);
+
+  template <typename FloatType>
+  static void PutPoint(const FloatType* position,
+                       const FloatType* colour,
+                       FloatType conf,
+                       unsigned int numTexCoords,
+                       io::TextEmitter* pOut);
+
+  template <typename FloatType>
+  static void PutTextureCoordinate(unsigned int texId,
+                                   FloatType u,
+                                   FloatType v,
+                                   io::TextEmitter* pOut);
+
+  template <typename FloatType>
+  static void FormatBatch(const io::PointBatch<FloatType>& batch,
+                          io::TextEmitter* pOut);
+
+  template <typename FloatType>
+  static void FormatPoints(
+    const OutputAdapterInterface<FloatType>* pOutputAdapter,
+    unsigned int begin,
+    unsigned int end,
+    io::TextEmitter* pOut);
+
+  template <typename FloatType>
+  void WritePointsConcurrently(
+    OutputAdapterInterface<FloatType>* pOutputAdapter,
+    io::TextEmitter* pOut);
+
+  template <typename ValueType>
+  static void WriteColumnAt(const std::vector<ValueType>& values,
+                            std::size_t offset,
+                            std::ostream& output);
+
+  static void PadTo(std::size_t offset,
+                    std::ostream& output,
+                    std::size_t* pPosition);
+
+  /// Points formatted per task when writing concurrently.
+  static const unsigned int kPointsPerChunk = 16384u;
+
   boost::filesystem::path fOutputPath;
   RmvVersion fVersion;
+  unsigned int fNumThreads;
 };  // class
 
 
@@ -101,29 +173,36 @@ RmvWriter::Write
 	{
 		this->WriteVersion1(pOutputAdapter);
 	}
+	else if (this->fVersion == kRmvVersion020)
+	{
+		this->WriteVersion2(pOutputAdapter);
+	}
 }
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the textual RMV_1 format through an io::TextEmitter, so neither
+/// a flush nor locale-aware formatting is paid per point.
+////////////////////////////////////////////////////////////////////////////////
 template <typename FloatType>
 void
 RmvWriter::WriteVersion1
 (OutputAdapterInterface<FloatType>* pOutputAdapter)
 {
-  std::ofstream ofs;
-  ofs.open(this->fOutputPath.c_str());
-
-  const std::string delimiter = ";";
+  io::TextEmitter out(this->fOutputPath.string());
 
   // write version of RMV file
-  ofs << "RMV_1" << std::endl;
+  out.Put(std::string("RMV_1"));
+  out.Put('\n');
 
   // additional empty line (see file format, wiki)
-  ofs << std::endl;
+  out.Put('\n');
 
   // write the number of textures
   unsigned int numTex = pOutputAdapter->CountTextures();
-  ofs << numTex << std::endl;
+  out.Put(numTex);
+  out.Put('\n');
 
   // write the textures
   for (unsigned int i=0; i<numTex; ++i)
@@ -139,81 +218,471 @@ RmvWriter::WriteVersion1
     unsigned int width, height;
     pOutputAdapter->GetTextureSize(&width, &height);
 
-    FloatType posX, posY, posZ;
-    pOutputAdapter->GetTexturePosition(&posX, &posY, &posZ);
+    FloatType position[3];
+    pOutputAdapter->GetTexturePosition(
+      &position[0], &position[1], &position[2]);
 
-    FloatType dirX, dirY, dirZ;
-    pOutputAdapter->GetTextureDirection(&dirX, &dirY, &dirZ);
+    FloatType direction[3];
+    pOutputAdapter->GetTextureDirection(
+      &direction[0], &direction[1], &direction[2]);
 
-    ofs << texId
-        << delimiter << filename
-        << delimiter << width
-        << delimiter << height
-        << delimiter << posX
-        << delimiter << posY
-        << delimiter << posZ
-        << delimiter << dirX
-        << delimiter << dirY
-        << delimiter << dirZ
-        << std::endl;
+    RmvWriter::PutTexture(
+      texId, filename, width, height, position, direction, &out);
   }
 
   // additional empty line (see file format, wiki)
-  ofs << std::endl;
+  out.Put('\n');
 
 
   // write number of points
   unsigned int numPts = pOutputAdapter->CountPoints();
-  ofs << numPts << std::endl;
+  out.Put(numPts);
+  out.Put('\n');
 
   // write points
-  for (int i=0; i<numPts; ++i)
+  if (pOutputAdapter->SupportsRandomAccess() &&
+      io::ParallelTools::GetNumThreads(this->fNumThreads) > 1u)
+  {
+    this->WritePointsConcurrently(pOutputAdapter, &out);
+  }
+  else
   {
-    pOutputAdapter->FetchNextPoint();
+    io::PointBatch<FloatType> batch;
+    for (unsigned int i=0; i<numPts; i+=batch.GetSize())
+    {
+      pOutputAdapter->FetchPointBatch(
+        &batch,
+        std::min(numPts - i, static_cast<unsigned int>(io::kPointBatchSize)));
+      RmvWriter::FormatBatch(batch, &out);
+    }
+  }
+
+  out.Close();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes an RMV_1 texture line.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::PutTexture
+(unsigned int texId,
+ const std::string& fileName,
+ unsigned int width,
+ unsigned int height,
+ const FloatType* position,
+ const FloatType* direction,
+ io::TextEmitter* pOut)
+{
+  const char delimiter = ';';
+  pOut->Put(texId);
+  pOut->Put(delimiter); pOut->Put(fileName);
+  pOut->Put(delimiter); pOut->Put(width);
+  pOut->Put(delimiter); pOut->Put(height);
+  pOut->Put(delimiter); pOut->Put(position[0]);
+  pOut->Put(delimiter); pOut->Put(position[1]);
+  pOut->Put(delimiter); pOut->Put(position[2]);
+  pOut->Put(delimiter); pOut->Put(direction[0]);
+  pOut->Put(delimiter); pOut->Put(direction[1]);
+  pOut->Put(delimiter); pOut->Put(direction[2]);
+  pOut->Put('\n');
+}
 
-    FloatType x,y,z;
-    pOutputAdapter->GetPointPosition(&x, &y, &z);
 
-    FloatType r,g,b;
-    pOutputAdapter->GetPointColour(&r, &g, &b);
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the per-point part of an RMV_1 point line, up to and including the
+/// number of texture coordinates.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::PutPoint
+(const FloatType* position,
+ const FloatType* colour,
+ FloatType conf,
+ unsigned int numTexCoords,
+ io::TextEmitter* pOut)
+{
+  const char delimiter = ';';
+  pOut->Put(position[0]);
+  pOut->Put(delimiter); pOut->Put(position[1]);
+  pOut->Put(delimiter); pOut->Put(position[2]);
+  pOut->Put(delimiter); pOut->Put(colour[0]);
+  pOut->Put(delimiter); pOut->Put(colour[1]);
+  pOut->Put(delimiter); pOut->Put(colour[2]);
+  pOut->Put(delimiter); pOut->Put(conf);
+  pOut->Put(delimiter); pOut->Put(numTexCoords);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::PutTextureCoordinate
+(unsigned int texId, FloatType u, FloatType v, io::TextEmitter* pOut)
+{
+  const char delimiter = ';';
+  pOut->Put(delimiter); pOut->Put(texId);
+  pOut->Put(delimiter); pOut->Put(u);
+  pOut->Put(delimiter); pOut->Put(v);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Formats the point lines of a batch fetched from an output adapter.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::FormatBatch
+(const io::PointBatch<FloatType>& batch, io::TextEmitter* pOut)
+{
+  const std::size_t numPoints = batch.GetSize();
+  for (std::size_t point = 0u; point < numPoints; ++point)
+  {
+    const unsigned int firstTexCoord = batch.fTexCoordOffsets[point];
+    const unsigned int lastTexCoord = batch.fTexCoordOffsets[point + 1u];
+
+    RmvWriter::PutPoint(&batch.fPositions[3u * point],
+                        &batch.fColours[3u * point],
+                        batch.fConfidences[point],
+                        lastTexCoord - firstTexCoord,
+                        pOut);
+    for (unsigned int texCoord = firstTexCoord;
+         texCoord < lastTexCoord;
+         ++texCoord)
+    {
+      RmvWriter::PutTextureCoordinate(batch.fTexCoordIds[texCoord],
+                                      batch.fTexCoords[2u * texCoord],
+                                      batch.fTexCoords[2u * texCoord + 1u],
+                                      pOut);
+    }
+    pOut->Put('\n');
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Formats the points [begin, end) of a random access adapter into pOut.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::FormatPoints
+(const OutputAdapterInterface<FloatType>* pOutputAdapter,
+ unsigned int begin,
+ unsigned int end,
+ io::TextEmitter* pOut)
+{
+  pOut->Clear();
+  for (unsigned int i = begin; i < end; ++i)
+  {
+    FloatType position[3];
+    FloatType colour[3];
     FloatType conf;
-    pOutputAdapter->GetPointConfidence(&conf);
+    pOutputAdapter->GetPoint(i, position, colour, &conf);
+
+    const unsigned int* texIds = NULL;
+    const FloatType* texCoords = NULL;
+    const unsigned int numTexCoords =
+      pOutputAdapter->GetPointTexCoords(i, &texIds, &texCoords);
+
+    RmvWriter::PutPoint(position, colour, conf, numTexCoords, pOut);
+    for (unsigned int j = 0u; j < numTexCoords; ++j)
+    {
+      RmvWriter::PutTextureCoordinate(
+        texIds[j], texCoords[2u * j], texCoords[2u * j + 1u], pOut);
+    }
+    pOut->Put('\n');
+  }
+}
+
+
 
-    ofs << x
-        << delimiter << y
-        << delimiter << z
-        << delimiter << r
-        << delimiter << g
-        << delimiter << b
-        << delimiter << conf;
 
-    // retrieve number of tex coordinates for this 3D point
-    unsigned int numPtTexCoords = pOutputAdapter->CountPointTextureCoordinates();
 
-    ofs << delimiter << numPtTexCoords;
+////////////////////////////////////////////////////////////////////////////////
+/// Formats the points of a random access adapter in chunks on fNumThreads
+/// threads.
+/// The chunks are processed in rounds, each round being appended to the
+/// file in order before the next one starts, which bounds the memory used
+/// for the formatted text.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::WritePointsConcurrently
+(OutputAdapterInterface<FloatType>* pOutputAdapter, io::TextEmitter* pOut)
+{
+  const unsigned int numPts = pOutputAdapter->CountPoints();
+
+  io::WorkStealingPool pool(this->fNumThreads);
+  const unsigned int numChunks = 4u * pool.GetNumThreads();
+  boost::scoped_array<io::TextEmitter> chunks(new io::TextEmitter[numChunks]);
 
-    // retrieve tex coordinates for this 3D point and write to stream
-    unsigned int ptTexId;
-    FloatType u,v;
-    for (int j=0; j<numPtTexCoords; ++j)
+  std::vector<io::WorkStealingPool::Task> tasks;
+  for (unsigned int round = 0u; round < numPts;
+       round += numChunks * kPointsPerChunk)
+  {
+    tasks.clear();
+    for (unsigned int chunk = 0u; chunk < numChunks; ++chunk)
     {
-      pOutputAdapter->FetchNextPointTextureCoordinate();
+      const unsigned int begin = round + chunk * kPointsPerChunk;
+      if (begin >= numPts)
+      {
+        break;
+      }
+      const unsigned int end = std::min(begin + kPointsPerChunk, numPts);
+      tasks.push_back(boost::bind(&RmvWriter::FormatPoints<FloatType>,
+                                  pOutputAdapter, begin, end, &chunks[chunk]));
+    }
 
-      pOutputAdapter->GetPointTextureCoordinate(&ptTexId, &u, &v);
+    pool.Run(tasks);
 
-      ofs << delimiter << ptTexId
-          << delimiter << u
-          << delimiter << v;
+    for (std::size_t chunk = 0u; chunk < tasks.size(); ++chunk)
+    {
+      pOut->Put(chunks[chunk]);
     }
+  }
+}
 
-    ofs << std::endl;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the binary RMV_2 format (see io::RmvFormat). Each batch of points
+/// is written to the columns right away, so only one batch is held in
+/// memory.
+////////////////////////////////////////////////////////////////////////////////
+template <typename FloatType>
+void
+RmvWriter::WriteVersion2
+(OutputAdapterInterface<FloatType>* pOutputAdapter)
+{
+  namespace bf = boost::filesystem;
+  namespace rf = io::RmvFormat;
+
+  rf::Header header = rf::Header();
+  header.fScalarType = (sizeof(FloatType) == sizeof(float))
+    ? rf::kScalarTypeFloat32 : rf::kScalarTypeFloat64;
+
+  // textures
+  std::vector<char> textures;
+  const unsigned int numTex = pOutputAdapter->CountTextures();
+  for (unsigned int i = 0; i < numTex; ++i)
+  {
+    pOutputAdapter->FetchNextTexture();
+
+    rf::TextureRecord texture;
+    pOutputAdapter->GetTextureID(&texture.fId);
+    pOutputAdapter->GetTextureFilename(&texture.fFileName);
+    pOutputAdapter->GetTextureSize(&texture.fWidth, &texture.fHeight);
+
+    FloatType posX, posY, posZ;
+    pOutputAdapter->GetTexturePosition(&posX, &posY, &posZ);
+    texture.fPosition[0] = posX;
+    texture.fPosition[1] = posY;
+    texture.fPosition[2] = posZ;
+
+    FloatType dirX, dirY, dirZ;
+    pOutputAdapter->GetTextureDirection(&dirX, &dirY, &dirZ);
+    texture.fDirection[0] = dirX;
+    texture.fDirection[1] = dirY;
+    texture.fDirection[2] = dirZ;
+
+    rf::AppendTexture(texture, &textures);
   }
 
-  if (ofs.is_open())
+  // The sections up to the tex coord ids do not depend on the number of tex
+  // coords, so points are written straight to their offsets. The tex coords
+  // are spooled to a second file until their offset is known, and the header
+  // is written last.
+  const unsigned int numPts = pOutputAdapter->CountPoints();
+  header.fNumTextures = numTex;
+  header.fNumPoints = numPts;
+  header.fNumTexCoords = 0u;
+  header.fTexturesSize = textures.size();
+  rf::ComputeLayout(&header);
+
+  std::ofstream ofs(this->fOutputPath.c_str(),
+                    std::ios_base::out | std::ios_base::binary);
+  if (!ofs.is_open())
   {
-    ofs.close();
+    std::cerr << "Could not open output file " << this->fOutputPath << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
   }
+
+  const bf::path spoolPath(
+    bf::unique_path(this->fOutputPath.string() + ".%%%%-%%%%.tmp"));
+  std::fstream spool(spoolPath.c_str(),
+                     std::ios_base::in | std::ios_base::out |
+                     std::ios_base::binary | std::ios_base::trunc);
+  if (!spool.is_open())
+  {
+    std::cerr << "Could not open temporary file " << spoolPath << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::size_t position = 0u;
+  RmvWriter::PadTo(header.fTexturesOffset, ofs, &position);
+  if (!textures.empty())
+  {
+    ofs.write(&textures[0], textures.size());
+    position += textures.size();
+  }
+  RmvWriter::PadTo(header.fPositionsOffset, ofs, &position);
+
+  for (unsigned int coord = 0u; coord < 3u; ++coord)
+  {
+    header.fBoundingBoxMin[coord] = std::numeric_limits<double>::max();
+    header.fBoundingBoxMax[coord] = -std::numeric_limits<double>::max();
+  }
+
+  const std::size_t scalarSize = sizeof(FloatType);
+  std::vector<boost::uint64_t> texCoordOffsets(1u, 0u);
+  RmvWriter::WriteColumnAt(
+    texCoordOffsets, header.fTexCoordOffsetsOffset, ofs);
+  std::size_t numTexCoords = 0u;
+  std::size_t spoolSize = 0u;
+  io::PointBatch<FloatType> batch;
+  for (unsigned int i = 0; i < numPts; i += batch.GetSize())
+  {
+    pOutputAdapter->FetchPointBatch(
+      &batch,
+      std::min(numPts - i, static_cast<unsigned int>(io::kPointBatchSize)));
+
+    for (std::size_t value = 0u; value < batch.fPositions.size(); ++value)
+    {
+      const unsigned int coord = value % 3u;
+      header.fBoundingBoxMin[coord] =
+        std::min(header.fBoundingBoxMin[coord],
+                 static_cast<double>(batch.fPositions[value]));
+      header.fBoundingBoxMax[coord] =
+        std::max(header.fBoundingBoxMax[coord],
+                 static_cast<double>(batch.fPositions[value]));
+    }
+
+    RmvWriter::WriteColumnAt(
+      batch.fPositions,
+      header.fPositionsOffset + 3u * i * scalarSize, ofs);
+    RmvWriter::WriteColumnAt(
+      batch.fColours,
+      header.fColoursOffset + 3u * i * scalarSize, ofs);
+    RmvWriter::WriteColumnAt(
+      batch.fConfidences,
+      header.fConfidencesOffset + i * scalarSize, ofs);
+
+    texCoordOffsets.resize(batch.GetSize());
+    for (std::size_t point = 0u; point < batch.GetSize(); ++point)
+    {
+      texCoordOffsets[point] =
+        numTexCoords + batch.fTexCoordOffsets[point + 1u];
+    }
+    RmvWriter::WriteColumnAt(
+      texCoordOffsets,
+      header.fTexCoordOffsetsOffset + (i + 1u) * sizeof(boost::uint64_t),
+      ofs);
+    RmvWriter::WriteColumnAt(
+      batch.fTexCoordIds,
+      header.fTexCoordIdsOffset + numTexCoords * sizeof(boost::uint32_t),
+      ofs);
+    rf::WriteColumn(batch.fTexCoords, spool, &spoolSize);
+    numTexCoords += batch.fTexCoordIds.size();
+  }
+  if (numPts == 0u)
+  {
+    for (unsigned int coord = 0u; coord < 3u; ++coord)
+    {
+      header.fBoundingBoxMin[coord] = 0.0;
+      header.fBoundingBoxMax[coord] = 0.0;
+    }
+  }
+
+  header.fNumTexCoords = numTexCoords;
+  rf::ComputeLayout(&header);
+
+  // zeros between the end of each point section and the next section
+  const boost::uint64_t sectionEnds[] =
+  {
+    header.fPositionsOffset + 3u * numPts * scalarSize,
+    header.fColoursOffset + 3u * numPts * scalarSize,
+    header.fConfidencesOffset + numPts * scalarSize,
+    header.fTexCoordOffsetsOffset +
+      (numPts + 1u) * sizeof(boost::uint64_t),
+    header.fTexCoordIdsOffset + numTexCoords * sizeof(boost::uint32_t)
+  };
+  const boost::uint64_t nextSections[] =
+  {
+    header.fColoursOffset,
+    header.fConfidencesOffset,
+    header.fTexCoordOffsetsOffset,
+    header.fTexCoordIdsOffset,
+    header.fTexCoordsOffset
+  };
+  for (unsigned int section = 0u; section < 5u; ++section)
+  {
+    position = sectionEnds[section];
+    ofs.seekp(static_cast<std::streamoff>(position));
+    RmvWriter::PadTo(nextSections[section], ofs, &position);
+  }
+
+  if (spoolSize > 0u)
+  {
+    spool.seekg(0);
+    ofs << spool.rdbuf();
+  }
+  const bool isSpooled = !spool.fail();
+  spool.close();
+  bf::remove(spoolPath);
+
+  char headerBytes[rf::kHeaderSize];
+  rf::WriteHeader(header, headerBytes);
+  ofs.seekp(0);
+  ofs.write(headerBytes, rf::kHeaderSize);
+  ofs.close();
+  if (!isSpooled || ofs.fail())
+  {
+    std::cerr << "Could not write output file " << this->fOutputPath << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes values as one little-endian column starting at the given offset.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ValueType>
+void
+RmvWriter::WriteColumnAt
+(const std::vector<ValueType>& values,
+ std::size_t offset,
+ std::ostream& output)
+{
+  std::size_t position = offset;
+  output.seekp(static_cast<std::streamoff>(offset));
+  io::RmvFormat::WriteColumn(values, output, &position);
 }
 
 
@@ -0,0 +1,291 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__TEXT_EMITTER_H_
+#define AVIGLE__IO__TEXT_EMITTER_H_
+
+
+#include <cstddef>
+#include <cstdio>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+  #include <charconv>
+#endif
+
+#include <boost/noncopyable.hpp>
+
+#include <io/io_api.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Buffered writer for the text formats. Values are formatted straight into
+/// a large buffer which is handed to the file in one piece when full, so
+/// writing a point costs neither a stream flush nor the locale machinery of
+/// std::ostream. Numbers are written exactly like std::ostream with its
+/// default settings does ("%.6g" for floating point numbers), so files stay
+/// byte-identical to those written via operator<<.
+/// Without a file name the emitter collects the text in memory, growing its
+/// buffer as needed, so that parts of a file can be formatted concurrently
+/// and appended to the file emitter in order afterwards.
+////////////////////////////////////////////////////////////////////////////////
+class IO_API TextEmitter : private boost::noncopyable
+{
+public:
+  TextEmitter();
+  TextEmitter(const std::string& fileName);
+  ~TextEmitter();
+
+  void Open(const std::string& fileName);
+  bool IsOpen() const { return this->fOutput.is_open(); }
+
+  const char* GetData() const
+  {
+    return this->fBuffer.empty() ? NULL : &this->fBuffer[0];
+  }
+  std::size_t GetSize() const { return this->fSize; }
+  void Clear() { this->fSize = 0u; }
+
+  inline void Put(char character);
+  inline void Put(const std::string& text);
+  inline void Put(unsigned int value);
+  inline void Put(float value);
+  inline void Put(double value);
+  void Put(const TextEmitter& text);
+
+  std::streampos Tell();
+  void Overwrite(std::streampos position, const std::string& text);
+
+  void Flush();
+  void Close();
+
+private:
+  /// Precision std::ostream uses by default.
+  static const int kFloatPrecision = 6;
+  /// Upper bound of the length of a single formatted number.
+  static const std::size_t kMaxNumberLength = 32u;
+  static const std::size_t kBufferSize = 1u << 20;
+
+  inline char* Reserve(std::size_t numBytes);
+  void Grow(std::size_t numBytes);
+  inline void PutFloatingPoint(double value);
+
+  std::ofstream fOutput;
+  bool fIsInMemory;
+  std::vector<char> fBuffer;
+  std::size_t fSize;
+};  // class
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns room for at least numBytes (at most kBufferSize when writing to a
+/// file) characters.
+////////////////////////////////////////////////////////////////////////////////
+inline
+char*
+TextEmitter::Reserve
+(std::size_t numBytes)
+{
+  if (this->fSize + numBytes > this->fBuffer.size())
+  {
+    if (this->fIsInMemory)
+    {
+      this->Grow(numBytes);
+    }
+    else
+    {
+      this->Flush();
+    }
+  }
+  return &this->fBuffer[this->fSize];
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::Put
+(char character)
+{
+  *this->Reserve(1u) = character;
+  ++this->fSize;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::Put
+(const std::string& text)
+{
+  if (this->fIsInMemory)
+  {
+    this->Reserve(text.size());
+  }
+
+  std::size_t written = 0u;
+  while (written < text.size())
+  {
+    const std::size_t available = this->fBuffer.size() - this->fSize;
+    const std::size_t numBytes = (text.size() - written < available)
+      ? text.size() - written : available;
+    text.copy(&this->fBuffer[this->fSize], numBytes, written);
+    this->fSize += numBytes;
+    written += numBytes;
+    if (written < text.size())
+    {
+      this->Flush();
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the digits back to front into a small scratch buffer.
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::Put
+(unsigned int value)
+{
+  char digits[16];
+  char* pFirst = digits + sizeof(digits);
+  do
+  {
+    *--pFirst = static_cast<char>('0' + value % 10u);
+    value /= 10u;
+  } while (value != 0u);
+
+  const std::size_t numDigits = digits + sizeof(digits) - pFirst;
+  char* pOut = this->Reserve(numDigits);
+  for (std::size_t i = 0u; i < numDigits; ++i)
+  {
+    pOut[i] = pFirst[i];
+  }
+  this->fSize += numDigits;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// std::ostream widens float to double before formatting, hence the float
+/// overload does the same.
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::Put
+(float value)
+{
+  this->PutFloatingPoint(static_cast<double>(value));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::Put
+(double value)
+{
+  this->PutFloatingPoint(value);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Without <charconv> the C library formats the number, which honours the
+/// decimal point of the C locale (see setlocale).
+////////////////////////////////////////////////////////////////////////////////
+inline
+void
+TextEmitter::PutFloatingPoint
+(double value)
+{
+  char* pOut = this->Reserve(kMaxNumberLength);
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+  const std::to_chars_result result =
+    std::to_chars(pOut, pOut + kMaxNumberLength, value,
+                  std::chars_format::general, kFloatPrecision);
+  this->fSize += result.ptr - pOut;
+#else
+  const int numChars =
+    std::snprintf(pOut, kMaxNumberLength, "%.*g", kFloatPrecision, value);
+  this->fSize += static_cast<std::size_t>(numChars);
+#endif
+}
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__TEXT_EMITTER_H_
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#ifndef AVIGLE__IO__WORK_STEALING_POOL_H_
+#define AVIGLE__IO__WORK_STEALING_POOL_H_
+
+
+#include <cstddef>
+
+#include <deque>
+#include <vector>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <io/io_api.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Runs a set of independent tasks of varying size on a number of threads.
+/// Every thread owns a queue of tasks. It takes tasks from the back of its own
+/// queue and, once that is empty, steals from the front of the other queues.
+/// Tasks receive the index of the thread running them, so they can keep
+/// per-thread state without locking.
+////////////////////////////////////////////////////////////////////////////////
+class IO_API WorkStealingPool : private boost::noncopyable
+{
+public:
+  typedef boost::function<void (unsigned int)> Task;
+
+  WorkStealingPool(unsigned int numThreads);
+  ~WorkStealingPool();
+
+  unsigned int GetNumThreads() const { return this->fNumThreads; }
+
+  void Run(const std::vector<Task>& tasks);
+
+private:
+  struct Queue
+  {
+    boost::mutex fMutex;
+    std::deque<std::size_t> fTasks;
+  };
+
+  void Work(unsigned int thread);
+  bool TakeTask(unsigned int thread, std::size_t* pTask);
+
+  unsigned int fNumThreads;
+  const std::vector<Task>* fpTasks;
+  boost::scoped_array<Queue> fQueues;
+
+  boost::mutex fErrorMutex;
+  boost::exception_ptr fError;
+  bool fIsAborted;
+};  // class
+
+
+} // namespace io
+
+
+#endif  // #ifndef AVIGLE__IO__WORK_STEALING_POOL_H_
@@ -0,0 +1,263 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <io/byte_order.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define AVIGLE__IO__HAS_SWAP_KERNELS
+#endif
+
+
+namespace io
+{
+
+namespace ByteOrder
+{
+
+typedef void (*SwapFunction)(char*, std::size_t, std::size_t);
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Swaps one scalar after the other. Handles any scalar size, and the tails
+/// the vector kernels leave.
+////////////////////////////////////////////////////////////////////////////////
+static
+void
+SwapScalarsOneByOne
+(char* pData,
+ std::size_t numScalars,
+ std::size_t scalarSize)
+{
+  if (scalarSize == 2u)
+  {
+    for (std::size_t scalar = 0u; scalar < numScalars; ++scalar)
+    {
+      boost::uint16_t value;
+      std::memcpy(&value, pData + 2u * scalar, sizeof(value));
+      boost::endian::endian_reverse_inplace(value);
+      std::memcpy(pData + 2u * scalar, &value, sizeof(value));
+    }
+  }
+  else if (scalarSize == 4u)
+  {
+    for (std::size_t scalar = 0u; scalar < numScalars; ++scalar)
+    {
+      boost::uint32_t value;
+      std::memcpy(&value, pData + 4u * scalar, sizeof(value));
+      boost::endian::endian_reverse_inplace(value);
+      std::memcpy(pData + 4u * scalar, &value, sizeof(value));
+    }
+  }
+  else if (scalarSize == 8u)
+  {
+    for (std::size_t scalar = 0u; scalar < numScalars; ++scalar)
+    {
+      boost::uint64_t value;
+      std::memcpy(&value, pData + 8u * scalar, sizeof(value));
+      boost::endian::endian_reverse_inplace(value);
+      std::memcpy(pData + 8u * scalar, &value, sizeof(value));
+    }
+  }
+  else
+  {
+    for (std::size_t scalar = 0u; scalar < numScalars; ++scalar)
+    {
+      std::reverse(pData + scalarSize * scalar,
+                   pData + scalarSize * (scalar + 1u));
+    }
+  }
+}
+
+
+
+
+
+#ifdef AVIGLE__IO__HAS_SWAP_KERNELS
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the pshufb control that reverses the bytes of each scalar of 2, 4
+/// or 8 bytes within 32 bytes. Both 16 byte lanes are alike, as the AVX2
+/// shuffle works per lane.
+////////////////////////////////////////////////////////////////////////////////
+static
+const char*
+GetShuffleControl
+(std::size_t scalarSize)
+{
+  static const char kControls[3][32] =
+  {
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+      1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+      7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 }
+  };
+  return kControls[(scalarSize == 2u) ? 0 : (scalarSize == 4u) ? 1 : 2];
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Swaps scalars of 2, 4 or 8 bytes 16 bytes at a time.
+////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("ssse3")))
+static
+void
+SwapScalarsSsse3
+(char* pData,
+ std::size_t numScalars,
+ std::size_t scalarSize)
+{
+  const __m128i control = _mm_loadu_si128(
+    reinterpret_cast<const __m128i*>(GetShuffleControl(scalarSize)));
+  const std::size_t numBytes = numScalars * scalarSize;
+  std::size_t byte = 0u;
+  for (; byte + 16u <= numBytes; byte += 16u)
+  {
+    __m128i* const pBlock = reinterpret_cast<__m128i*>(pData + byte);
+    _mm_storeu_si128(pBlock,
+                     _mm_shuffle_epi8(_mm_loadu_si128(pBlock), control));
+  }
+  SwapScalarsOneByOne(pData + byte, (numBytes - byte) / scalarSize,
+                      scalarSize);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Swaps scalars of 2, 4 or 8 bytes 32 bytes at a time.
+////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2")))
+static
+void
+SwapScalarsAvx2
+(char* pData,
+ std::size_t numScalars,
+ std::size_t scalarSize)
+{
+  const __m256i control = _mm256_loadu_si256(
+    reinterpret_cast<const __m256i*>(GetShuffleControl(scalarSize)));
+  const std::size_t numBytes = numScalars * scalarSize;
+  std::size_t byte = 0u;
+  for (; byte + 32u <= numBytes; byte += 32u)
+  {
+    __m256i* const pBlock = reinterpret_cast<__m256i*>(pData + byte);
+    _mm256_storeu_si256(pBlock,
+                        _mm256_shuffle_epi8(_mm256_loadu_si256(pBlock),
+                                            control));
+  }
+  SwapScalarsOneByOne(pData + byte, (numBytes - byte) / scalarSize,
+                      scalarSize);
+}
+#endif  // #ifdef AVIGLE__IO__HAS_SWAP_KERNELS
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Picks the widest kernel the processor supports.
+////////////////////////////////////////////////////////////////////////////////
+static
+SwapFunction
+SelectSwapFunction
+()
+{
+#ifdef AVIGLE__IO__HAS_SWAP_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return &SwapScalarsAvx2;
+  }
+  else if (__builtin_cpu_supports("ssse3"))
+  {
+    return &SwapScalarsSsse3;
+  }
+#endif
+  return &SwapScalarsOneByOne;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+SwapScalars
+(void* pData,
+ std::size_t numScalars,
+ std::size_t scalarSize)
+{
+  static const SwapFunction swapFunction = SelectSwapFunction();
+
+  char* const pBytes = static_cast<char*>(pData);
+  if (scalarSize == 2u || scalarSize == 4u || scalarSize == 8u)
+  {
+    swapFunction(pBytes, numScalars, scalarSize);
+  }
+  else if (scalarSize > 1u)
+  {
+    SwapScalarsOneByOne(pBytes, numScalars, scalarSize);
+  }
+}
+
+} // namespace ByteOrder
+
+
+} // namespace io
@@ -41,7 +41,12 @@
 //     DOI: 10.1109/ISVRI.2011.5759608
 //------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cstdlib>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 
@@ -52,11 +57,13 @@ namespace io
 {
 
 ////////////////////////////////////////////////////////////////////////////////
-///
+/// Collects all numbered cluster directories (00, 01, ...) of the input
+/// directory that contain a cameras file.
 ////////////////////////////////////////////////////////////////////////////////
 CmvsReader::CmvsReader
-(const std::string& fileName)
+(const std::string& fileName, const io::LoadOptions& loadOptions)
 : fInputPath(fileName)
+, fLoadOptions(loadOptions)
 {
   namespace bf = boost::filesystem;
 
@@ -68,45 +75,71 @@ CmvsReader::CmvsReader
     exit(EXIT_FAILURE);
   }
 
-  // determine cameras path
-  this->fCamerasPath = bf::absolute("00", this->fInputPath);
-  this->fCamerasPath /= "cameras.txt";
-  if (!bf::exists(this->fCamerasPath))
+  // find cluster directories
+  std::vector<std::pair<unsigned long, bf::path> > clusterPaths;
+  bf::directory_iterator inputDirIter(this->fInputPath);
+  bf::directory_iterator inputDirEnd;
+  for (; inputDirIter != inputDirEnd; ++inputDirIter)
   {
-    std::cerr << "Did not find cameras file " << this->fCamerasPath << "!" << std::endl;
-    std::cerr << "Terminating." << std::endl;
-    exit(EXIT_FAILURE);
+    const std::string name(inputDirIter->path().filename().string());
+    if (name.empty() ||
+        name.find_first_not_of("0123456789") != std::string::npos ||
+        !bf::is_directory(inputDirIter->path()) ||
+        !bf::exists(inputDirIter->path() / "cameras.txt"))
+    {
+      continue;
+    }
+    clusterPaths.push_back(
+      std::make_pair(std::strtoul(name.c_str(), NULL, 10),
+                     inputDirIter->path()));
   }
+  std::sort(clusterPaths.begin(), clusterPaths.end());
 
-  // determine patches path
-  this->fPatchesPath = bf::absolute("00", this->fInputPath);
-  this->fPatchesPath /= "models";
-  if (!bf::exists(this->fPatchesPath))
+  if (clusterPaths.empty())
   {
-    std::cerr << "Did not find patches path " << this->fPatchesPath << "!" << std::endl;
+    std::cerr << "Did not find cameras file "
+      << this->fInputPath / "00" / "cameras.txt" << "!" << std::endl;
     std::cerr << "Terminating." << std::endl;
     exit(EXIT_FAILURE);
   }
 
-  // detemine texture images path
-  this->fTextureImagePath = bf::absolute("00", this->fInputPath);
-  this->fTextureImagePath /= "visualize";
-  if (!bf::exists(this->fTextureImagePath))
+  for (std::size_t cluster = 0u; cluster < clusterPaths.size(); ++cluster)
   {
-    std::cerr << "Did not find texture images path " << this->fTextureImagePath << "!" << std::endl;
-    std::cerr << "Terminating." << std::endl;
-    exit(EXIT_FAILURE);
-  }
-
-  // detemine projection matrix folder
-  this->fProjectionMatrixFolder = bf::absolute("00", this->fInputPath);
-  this->fProjectionMatrixFolder /= "txt";
-  if (!bf::exists(this->fProjectionMatrixFolder))
-  {
-    std::cerr << "Did not find projection matrix folder "
-      << this->fProjectionMatrixFolder << "!" << std::endl;
-    std::cerr << "Terminating." << std::endl;
-    exit(EXIT_FAILURE);
+    const bf::path& clusterPath = clusterPaths[cluster].second;
+    Cluster paths;
+
+    // determine cameras path
+    paths.fCamerasPath = clusterPath / "cameras.txt";
+
+    // determine patches path
+    paths.fPatchesPath = clusterPath / "models";
+    if (!bf::exists(paths.fPatchesPath))
+    {
+      std::cerr << "Did not find patches path " << paths.fPatchesPath << "!" << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // detemine texture images path
+    paths.fTextureImagePath = clusterPath / "visualize";
+    if (!bf::exists(paths.fTextureImagePath))
+    {
+      std::cerr << "Did not find texture images path " << paths.fTextureImagePath << "!" << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // detemine projection matrix folder
+    paths.fProjectionMatrixFolder = clusterPath / "txt";
+    if (!bf::exists(paths.fProjectionMatrixFolder))
+    {
+      std::cerr << "Did not find projection matrix folder "
+        << paths.fProjectionMatrixFolder << "!" << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    this->fClusters.push_back(paths);
   }
 }
 
@@ -123,4 +156,55 @@ CmvsReader::~CmvsReader
 }
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Counts textures and points without parsing any point. The cameras are
+/// read to identify the textures shared by several clusters (see Load()),
+/// the points are summed up from the headers of the .patch files.
+////////////////////////////////////////////////////////////////////////////////
+void
+CmvsReader::Probe
+(io::DatasetInfo* pInfo)
+{
+  namespace bf = boost::filesystem;
+
+  std::set<std::string> projections;
+  for (std::size_t cluster = 0u; cluster < this->fClusters.size(); ++cluster)
+  {
+    const Cluster& paths = this->fClusters[cluster];
+    pInfo->AddFile(bf::file_size(paths.fCamerasPath));
+
+    std::vector<Camera<double> > cameras;
+    CmvsReader::LoadCameras(&paths, &cameras);
+    for (std::size_t texNum = 0u; texNum < cameras.size(); ++texNum)
+    {
+      projections.insert(cameras[texNum].fProjectionKey);
+    }
+
+    bf::directory_iterator patchesDirIter(paths.fPatchesPath);
+    bf::directory_iterator patchesDirEnd;
+    for (; patchesDirIter != patchesDirEnd; ++patchesDirIter)
+    {
+      if (patchesDirIter->path().extension().compare(std::string(".patch")) == 0)
+      {
+        bf::path pointsFile(patchesDirIter->path());
+        pointsFile.replace_extension(std::string(".ply"));
+
+        pInfo->AddFile(bf::file_size(patchesDirIter->path()));
+        if (bf::exists(pointsFile))
+        {
+          pInfo->AddFile(bf::file_size(pointsFile));
+        }
+        pInfo->fNumPoints += io::ReaderTools::CountPatches(
+          patchesDirIter->path().string());
+      } // if .patch file
+    } // for all .patch files
+  } // for all clusters
+
+  pInfo->fNumTextures = projections.size();
+}
+
+
 } // namespace io
@@ -82,4 +82,37 @@ DenseReader::~DenseReader
 }
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sums up the points announced by the headers of the .patch files.
+////////////////////////////////////////////////////////////////////////////////
+void
+DenseReader::Probe
+(io::DatasetInfo* pInfo)
+{
+  namespace bf = boost::filesystem;
+
+  bf::directory_iterator patchesDirIter(this->fInputPath);
+  bf::directory_iterator patchesDirEnd;
+  for (; patchesDirIter != patchesDirEnd; ++patchesDirIter)
+  {
+    if (patchesDirIter->path().extension().compare(std::string(".patch")) == 0)
+    {
+      bf::path pointsFile(patchesDirIter->path());
+      pointsFile.replace_extension(std::string(".ply"));
+
+      pInfo->AddFile(bf::file_size(patchesDirIter->path()));
+      if (bf::exists(pointsFile))
+      {
+        pInfo->AddFile(bf::file_size(pointsFile));
+      }
+      pInfo->fNumPoints += io::ReaderTools::CountPatches(
+        patchesDirIter->path().string());
+    }
+  }
+}
+
+
 } // namespace io
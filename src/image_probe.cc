@@ -0,0 +1,585 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <cstdlib>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifndef WIN32
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <io/image_probe.h>
+#include <io/mapped_file.h>
+#include <io/reader_tools.h>
+#include <io/work_stealing_pool.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+ImageProbe::ImageProbe
+(const std::string& cacheFileName)
+: fCacheFileName(cacheFileName)
+, fCache()
+, fIsCacheModified(false)
+, fListedSizes()
+, fDefaultSize(0u, 0u)
+{
+  this->Load();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Configures the probe from the image options of a loader.
+////////////////////////////////////////////////////////////////////////////////
+ImageProbe::ImageProbe
+(const io::LoadOptions& loadOptions)
+: fCacheFileName(loadOptions.fImageCacheFileName)
+, fCache()
+, fIsCacheModified(false)
+, fListedSizes()
+, fDefaultSize(loadOptions.fImageWidth, loadOptions.fImageHeight)
+{
+  this->Load();
+  if (!loadOptions.fImageSizesFileName.empty())
+  {
+    this->ReadSizeList(loadOptions.fImageSizesFileName);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes new cache entries back to the cache file.
+////////////////////////////////////////////////////////////////////////////////
+ImageProbe::~ImageProbe
+()
+{
+  this->Save();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sets the size of all images not in the size list. 0 x 0 reads the sizes
+/// from the images.
+////////////////////////////////////////////////////////////////////////////////
+void
+ImageProbe::SetDefaultSize
+(unsigned int width, unsigned int height)
+{
+  this->fDefaultSize = Size(width, height);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads a list of image sizes, one "<image file> <width> <height>" per line,
+/// file names relative to the list.
+////////////////////////////////////////////////////////////////////////////////
+void
+ImageProbe::ReadSizeList
+(const std::string& fileName)
+{
+  namespace bf = boost::filesystem;
+  namespace iort = io::ReaderTools;
+
+  io::MappedFile sizesFile(fileName);
+  if (!sizesFile.IsOpen())
+  {
+    std::cerr << "Could not open image size list " << fileName << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  const bf::path sizesFolder(bf::absolute(bf::path(fileName)).parent_path());
+  iort::Tokens sizeTokens(" \t\r");
+  const char* begin = NULL;
+  const char* end = NULL;
+  while (iort::NonCommentLine(sizesFile, &begin, &end))
+  {
+    sizeTokens.Assign(begin, end);
+    const bf::path imageFile(
+      bf::absolute(bf::path(iort::Token<std::string>(sizeTokens)),
+                   sizesFolder));
+    const unsigned int width = iort::Token<unsigned int>(sizeTokens);
+    const unsigned int height = iort::Token<unsigned int>(sizeTokens);
+    this->fListedSizes[imageFile.lexically_normal().string()] =
+      Size(width, height);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the size of one image. Returns false, leaving 0 x 0, if the
+/// image cannot be read. May be called from several threads at once.
+////////////////////////////////////////////////////////////////////////////////
+bool
+ImageProbe::GetSize
+(const std::string& fileName,
+ unsigned int* pWidth,
+ unsigned int* pHeight)
+{
+  namespace bf = boost::filesystem;
+
+  *pWidth = 0u;
+  *pHeight = 0u;
+  const std::string key(ImageProbe::Normalise(fileName));
+
+  const std::map<std::string, Size>::const_iterator listed =
+    this->fListedSizes.find(key);
+  if (listed != this->fListedSizes.end())
+  {
+    *pWidth = listed->second.first;
+    *pHeight = listed->second.second;
+    return true;
+  }
+  if (this->fDefaultSize.first != 0u && this->fDefaultSize.second != 0u)
+  {
+    *pWidth = this->fDefaultSize.first;
+    *pHeight = this->fDefaultSize.second;
+    return true;
+  }
+
+  CacheEntry entry;
+  boost::system::error_code error;
+  entry.fModificationTime = bf::last_write_time(key, error);
+  if (!error)
+  {
+    entry.fFileSize = bf::file_size(key, error);
+  }
+  if (error)
+  {
+    return false;
+  }
+
+  if (!this->fCacheFileName.empty())
+  {
+    boost::unique_lock<boost::mutex> lock(this->fMutex);
+    const std::map<std::string, CacheEntry>::const_iterator cached =
+      this->fCache.find(key);
+    if (cached != this->fCache.end() &&
+        cached->second.fModificationTime == entry.fModificationTime &&
+        cached->second.fFileSize == entry.fFileSize)
+    {
+      *pWidth = cached->second.fSize.first;
+      *pHeight = cached->second.fSize.second;
+      return true;
+    }
+  }
+
+  if (!ImageProbe::ReadJpegSize(key, pWidth, pHeight))
+  {
+    return false;
+  }
+
+  if (!this->fCacheFileName.empty())
+  {
+    entry.fSize = Size(*pWidth, *pHeight);
+    boost::unique_lock<boost::mutex> lock(this->fMutex);
+    this->fCache[key] = entry;
+    this->fIsCacheModified = true;
+  }
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the sizes of all given images on numThreads threads (0 uses
+/// one per hardware thread). Images that cannot be read get 0 x 0. Returns
+/// false if there are any.
+////////////////////////////////////////////////////////////////////////////////
+bool
+ImageProbe::GetSizes
+(const std::vector<std::string>& fileNames,
+ std::vector<unsigned int>* pWidths,
+ std::vector<unsigned int>* pHeights,
+ unsigned int numThreads)
+{
+  const std::size_t numImages = fileNames.size();
+  pWidths->assign(numImages, 0u);
+  pHeights->assign(numImages, 0u);
+
+  std::vector<io::WorkStealingPool::Task> probeTasks;
+  probeTasks.reserve(numImages);
+  for (std::size_t image = 0u; image < numImages; ++image)
+  {
+    probeTasks.push_back(boost::bind(&ImageProbe::ProbeTask,
+                                     this,
+                                     &fileNames[image],
+                                     &(*pWidths)[image],
+                                     &(*pHeights)[image]));
+  }
+  io::WorkStealingPool pool(numThreads);
+  pool.Run(probeTasks);
+
+  for (std::size_t image = 0u; image < numImages; ++image)
+  {
+    if ((*pWidths)[image] == 0u || (*pHeights)[image] == 0u)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+ImageProbe::ProbeTask
+(const std::string* pFileName,
+ unsigned int* pWidth,
+ unsigned int* pHeight)
+{
+  this->GetSize(*pFileName, pWidth, pHeight);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the cache file if entries were added. The file is replaced as a
+/// whole, so concurrent readers never see a partial cache.
+////////////////////////////////////////////////////////////////////////////////
+bool
+ImageProbe::Save
+()
+{
+  namespace bf = boost::filesystem;
+
+  boost::unique_lock<boost::mutex> lock(this->fMutex);
+  if (this->fCacheFileName.empty() || !this->fIsCacheModified)
+  {
+    return true;
+  }
+
+  const std::string temporaryFileName(this->fCacheFileName + ".tmp");
+  {
+    std::ofstream cacheFile(temporaryFileName.c_str());
+    if (!cacheFile.is_open())
+    {
+      return false;
+    }
+    cacheFile << "# image sizes: "
+              << "<modification time> <file size> <width> <height> <file>"
+              << std::endl;
+    std::map<std::string, CacheEntry>::const_iterator entry =
+      this->fCache.begin();
+    for (; entry != this->fCache.end(); ++entry)
+    {
+      cacheFile << static_cast<long long>(entry->second.fModificationTime)
+                << " " << entry->second.fFileSize
+                << " " << entry->second.fSize.first
+                << " " << entry->second.fSize.second
+                << " " << entry->first << "\n";
+    }
+    if (!cacheFile.good())
+    {
+      return false;
+    }
+  }
+
+  boost::system::error_code error;
+  bf::rename(temporaryFileName, this->fCacheFileName, error);
+  if (error)
+  {
+    return false;
+  }
+  this->fIsCacheModified = false;
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the cache file if there is one. Unreadable lines are dropped, they
+/// are probed again.
+////////////////////////////////////////////////////////////////////////////////
+void
+ImageProbe::Load
+()
+{
+  if (this->fCacheFileName.empty())
+  {
+    return;
+  }
+
+  std::ifstream cacheFile(this->fCacheFileName.c_str());
+  std::string line;
+  while (std::getline(cacheFile, line))
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+
+    std::istringstream lineStream(line);
+    long long modificationTime = 0;
+    CacheEntry entry;
+    std::string fileName;
+    if (lineStream >> modificationTime >> entry.fFileSize
+                   >> entry.fSize.first >> entry.fSize.second &&
+        lineStream.get() == ' ' &&
+        std::getline(lineStream, fileName) &&
+        !fileName.empty())
+    {
+      entry.fModificationTime = static_cast<std::time_t>(modificationTime);
+      this->fCache[fileName] = entry;
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Absolute, normalised file name, the key of listed and cached sizes.
+////////////////////////////////////////////////////////////////////////////////
+std::string
+ImageProbe::Normalise
+(const std::string& fileName)
+{
+  return boost::filesystem::absolute(
+    boost::filesystem::path(fileName)).lexically_normal().string();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads width and height from the frame header of a JPEG file (see
+/// FindJpegSize()). Uses pread where available and std::ifstream otherwise.
+////////////////////////////////////////////////////////////////////////////////
+bool
+ImageProbe::ReadJpegSize
+(const std::string& fileName,
+ unsigned int* pWidth,
+ unsigned int* pHeight)
+{
+#ifndef WIN32
+  const int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (fileDescriptor < 0)
+  {
+    return false;
+  }
+
+  const bool isValid = ImageProbe::FindJpegSize(
+    boost::bind(&ImageProbe::ReadFileBlock, fileDescriptor, _1, _2),
+    pWidth, pHeight);
+  close(fileDescriptor);
+  return isValid;
+#else
+  std::ifstream input(fileName.c_str(),
+                      std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open())
+  {
+    return false;
+  }
+
+  return ImageProbe::FindJpegSize(
+    boost::bind(&ImageProbe::ReadStreamBlock, &input, _1, _2),
+    pWidth, pHeight);
+#endif
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Walks the markers of a JPEG file up to the frame header. The segments
+/// before it, e.g. EXIF data in APP1, are skipped by their length, so
+/// thumbnails embedded there are not mistaken for the image. Reads one block
+/// of kHeaderBlockSize bytes, more only if the segments do not fit.
+////////////////////////////////////////////////////////////////////////////////
+bool
+ImageProbe::FindJpegSize
+(const BlockReadFunction& readBlock,
+ unsigned int* pWidth,
+ unsigned int* pHeight)
+{
+  unsigned char block[kHeaderBlockSize];
+  boost::uint64_t blockOffset = 0u;
+  std::size_t blockSize = readBlock(0u, block);
+
+  // start of image
+  bool isValid = (blockSize >= 2u && block[0] == 0xFF && block[1] == 0xD8);
+  boost::uint64_t position = 2u;
+  while (isValid)
+  {
+    // a marker, its segment length and, for frame headers, the size
+    if (position + 9u > blockOffset + blockSize)
+    {
+      blockOffset = position;
+      blockSize = readBlock(blockOffset, block);
+    }
+    const std::size_t available =
+      static_cast<std::size_t>(blockOffset + blockSize - position);
+    const unsigned char* const pMarker = block + (position - blockOffset);
+    if (available < 4u || pMarker[0] != 0xFF)
+    {
+      isValid = false;
+      break;
+    }
+
+    const unsigned char marker = pMarker[1];
+    if (marker == 0xFF)
+    {
+      // fill byte
+      ++position;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8))
+    {
+      // markers without segment
+      position += 2u;
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA)
+    {
+      // end of image or scan data before any frame header
+      isValid = false;
+      break;
+    }
+
+    // SOF0 ... SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+    if (marker >= 0xC0 && marker <= 0xCF &&
+        marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+    {
+      if (available < 9u)
+      {
+        isValid = false;
+        break;
+      }
+      *pHeight = (static_cast<unsigned int>(pMarker[5]) << 8) | pMarker[6];
+      *pWidth = (static_cast<unsigned int>(pMarker[7]) << 8) | pMarker[8];
+      break;
+    }
+
+    const unsigned int segmentLength =
+      (static_cast<unsigned int>(pMarker[2]) << 8) | pMarker[3];
+    if (segmentLength < 2u)
+    {
+      isValid = false;
+      break;
+    }
+    position += 2u + segmentLength;
+  }
+
+  return isValid;
+}
+
+
+
+
+
+#ifndef WIN32
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+std::size_t
+ImageProbe::ReadFileBlock
+(int fileDescriptor, boost::uint64_t offset, unsigned char* pBlock)
+{
+  const ssize_t numBytes = pread(fileDescriptor, pBlock, kHeaderBlockSize,
+                                 static_cast<off_t>(offset));
+  return (numBytes < 0) ? 0u : static_cast<std::size_t>(numBytes);
+}
+#endif
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+std::size_t
+ImageProbe::ReadStreamBlock
+(std::istream* pInput, boost::uint64_t offset, unsigned char* pBlock)
+{
+  // a short read before sets eofbit, which would fail the seek
+  pInput->clear();
+  pInput->seekg(static_cast<std::streamoff>(offset));
+  pInput->read(reinterpret_cast<char*>(pBlock), kHeaderBlockSize);
+  return static_cast<std::size_t>(pInput->gcount());
+}
+
+
+} // namespace io
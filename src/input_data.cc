@@ -83,7 +83,8 @@ InputData::Reset
   {
     if (inputPath.has_extension())
     {
-      if (inputPath.extension().compare(std::string(".rmv")) == 0)
+      if (inputPath.extension().compare(std::string(".rmv")) == 0 ||
+          inputPath.extension().compare(std::string(".rmvb")) == 0)
       {
         this->fFileType = io::InputData::kFileTypeRMV;
       }
@@ -131,4 +132,71 @@ InputData::Reset
 }
 
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the size of the data set from the headers of its files without
+/// loading any point, so it takes milliseconds even for huge data sets.
+////////////////////////////////////////////////////////////////////////////////
+io::DatasetInfo
+InputData::Probe
+()
+const
+{
+  io::DatasetInfo info;
+  if (this->fFileType == kFileTypeRMV)
+  {
+    RmvReader reader(this->fFileName, this->fLoadOptions);
+    reader.Probe(&info);
+  }
+  else if (this->fFileType == kFileTypeNVM)
+  {
+    NvmReader reader(this->fFileName, this->fLoadOptions);
+    reader.Probe(&info);
+  }
+  else if (this->fFileType == kFileTypeCMVS)
+  {
+    CmvsReader reader(this->fFileName, this->fLoadOptions);
+    reader.Probe(&info);
+  }
+  else if (this->fFileType == kFileTypePLY)
+  {
+    PlyReader reader(this->fFileName);
+    reader.Probe(&info);
+  }
+  else if (this->fFileType == kFileTypeDENSE)
+  {
+    DenseReader reader(this->fFileName);
+    reader.Probe(&info);
+  }
+  else
+  {
+    std::cerr << "Invalid file!" << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return info;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Opens the data set for zero-copy access. Only binary RMV files can be
+/// mapped; returns false for all other files (see ExportMapped()).
+////////////////////////////////////////////////////////////////////////////////
+bool
+InputData::Map
+(io::MappedDataset* pDataset)
+const
+{
+  if (this->fFileType != kFileTypeRMV)
+  {
+    return false;
+  }
+  return pDataset->Open(this->fFileName);
+}
+
+
 } // namespace io
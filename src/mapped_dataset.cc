@@ -0,0 +1,218 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <iostream>
+
+#include <boost/endian/conversion.hpp>
+
+#include <io/mapped_dataset.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+MappedDataset::MappedDataset
+()
+: fHeader()
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+MappedDataset::~MappedDataset
+()
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Maps the given binary RMV file. Returns false if the file cannot be read
+/// or is no valid RMV_2 file. Only the header and the textures are read, so
+/// opening takes the same time for any number of points.
+////////////////////////////////////////////////////////////////////////////////
+bool
+MappedDataset::Open
+(const std::string& fileName)
+{
+  namespace rf = io::RmvFormat;
+
+  this->Close();
+  if (boost::endian::order::native != boost::endian::order::little)
+  {
+    std::cerr << "MappedDataset: " << fileName
+      << ": mapping requires a little-endian host" << std::endl;
+    return false;
+  }
+
+  boost::scoped_ptr<io::MappedFile> pFile(new io::MappedFile(fileName));
+  if (!pFile->IsOpen() ||
+      !rf::ReadHeader(pFile->GetBegin(), pFile->GetEnd(), &this->fHeader))
+  {
+    this->fHeader = rf::Header();
+    return false;
+  }
+
+  const char* texturePosition = pFile->GetBegin() + this->fHeader.fTexturesOffset;
+  const char* const texturesEnd = texturePosition + this->fHeader.fTexturesSize;
+  this->fTextures.resize(this->fHeader.fNumTextures);
+  for (std::size_t texNum = 0u; texNum < this->fTextures.size(); ++texNum)
+  {
+    texturePosition =
+      rf::ReadTexture(texturePosition, texturesEnd, &this->fTextures[texNum]);
+    if (texturePosition == NULL)
+    {
+      this->Close();
+      return false;
+    }
+  }
+
+  const boost::uint64_t* offsets = reinterpret_cast<const boost::uint64_t*>(
+    pFile->GetBegin() + this->fHeader.fTexCoordOffsetsOffset);
+  if (offsets[0] != 0u ||
+      offsets[this->fHeader.fNumPoints] != this->fHeader.fNumTexCoords)
+  {
+    this->Close();
+    return false;
+  }
+
+  this->fpFile.swap(pFile);
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Checks that the tex coord offsets do not decrease. Touches the whole
+/// offsets column; call it before trusting a file from an unknown source.
+////////////////////////////////////////////////////////////////////////////////
+bool
+MappedDataset::Validate
+()
+const
+{
+  const io::ConstSpan<boost::uint64_t> offsets(this->GetTexCoordOffsets());
+  for (std::size_t point = 1u; point < offsets.size(); ++point)
+  {
+    if (offsets[point] < offsets[point - 1u])
+    {
+      return false;
+    }
+  }
+  return this->IsOpen();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+MappedDataset::Close
+()
+{
+  this->fpFile.reset();
+  this->fHeader = io::RmvFormat::Header();
+  this->fTextures.clear();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+io::ConstSpan<boost::uint64_t>
+MappedDataset::GetTexCoordOffsets
+()
+const
+{
+  if (!this->IsOpen())
+  {
+    return io::ConstSpan<boost::uint64_t>();
+  }
+  return io::ConstSpan<boost::uint64_t>(
+    reinterpret_cast<const boost::uint64_t*>(
+      this->fpFile->GetBegin() + this->fHeader.fTexCoordOffsetsOffset),
+    this->GetNumPoints() + 1u);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+io::ConstSpan<boost::uint32_t>
+MappedDataset::GetTexCoordIds
+()
+const
+{
+  if (!this->IsOpen())
+  {
+    return io::ConstSpan<boost::uint32_t>();
+  }
+  return io::ConstSpan<boost::uint32_t>(
+    reinterpret_cast<const boost::uint32_t*>(
+      this->fpFile->GetBegin() + this->fHeader.fTexCoordIdsOffset),
+    this->GetNumTexCoords());
+}
+
+
+} // namespace io
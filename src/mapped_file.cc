@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fstream>
+
+#ifndef WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <io/mapped_file.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+MappedFile::MappedFile
+(const std::string& fileName)
+: fBegin(NULL)
+, fSize(0u)
+, fPosition(NULL)
+, fIsOpen(false)
+, fIsMapped(false)
+, fBuffer()
+{
+  this->fIsOpen = (this->Map(fileName) || this->Read(fileName));
+  this->fPosition = this->fBegin;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+MappedFile::~MappedFile
+()
+{
+#ifndef WIN32
+  if (this->fIsMapped)
+  {
+    munmap(const_cast<char*>(this->fBegin), this->fSize);
+  }
+#endif
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Maps regular, non-empty files. Returns false if the file has to be read
+/// by other means.
+////////////////////////////////////////////////////////////////////////////////
+bool
+MappedFile::Map
+(const std::string& fileName)
+{
+#ifndef WIN32
+  const int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (fileDescriptor < 0)
+  {
+    return false;
+  }
+
+  struct stat fileStatus;
+  if (fstat(fileDescriptor, &fileStatus) != 0 ||
+      !S_ISREG(fileStatus.st_mode) ||
+      fileStatus.st_size <= 0)
+  {
+    close(fileDescriptor);
+    return false;
+  }
+
+  const std::size_t size = static_cast<std::size_t>(fileStatus.st_size);
+  void* pData = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (pData == MAP_FAILED)
+  {
+    return false;
+  }
+  madvise(pData, size, MADV_SEQUENTIAL);
+
+  this->fBegin = static_cast<const char*>(pData);
+  this->fSize = size;
+  this->fIsMapped = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fallback for pipes and other inputs that cannot be mapped.
+////////////////////////////////////////////////////////////////////////////////
+bool
+MappedFile::Read
+(const std::string& fileName)
+{
+  std::ifstream inputStream(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!inputStream.is_open())
+  {
+    return false;
+  }
+
+  const std::size_t blockSize = 1u << 20;
+  std::size_t size = 0u;
+  while (inputStream)
+  {
+    this->fBuffer.resize(size + blockSize);
+    inputStream.read(&this->fBuffer[size], blockSize);
+    size += static_cast<std::size_t>(inputStream.gcount());
+  }
+  this->fBuffer.resize(size);
+
+  this->fBegin = this->fBuffer.empty() ? NULL : &this->fBuffer[0];
+  this->fSize = size;
+  return true;
+}
+
+
+} // namespace io
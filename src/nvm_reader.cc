@@ -56,9 +56,11 @@ namespace io
 ///
 ////////////////////////////////////////////////////////////////////////////////
 NvmReader::NvmReader
-(const std::string& fileName)
+(const std::string& fileName,
+ const io::LoadOptions& loadOptions)
 : fInputPath(fileName)
 , fVersion(io::NvmReader::kNvmVersionInvalid)
+, fLoadOptions(loadOptions)
 {
   namespace bf = boost::filesystem;
 
@@ -88,118 +90,42 @@ NvmReader::~NvmReader
 
 
 ////////////////////////////////////////////////////////////////////////////////
-///
+/// Reads the counts without parsing any point and without opening the
+/// images. Only the camera lines between both counts are skipped.
 ////////////////////////////////////////////////////////////////////////////////
 void
-NvmReader::GetJpegSize
-(const std::string& fileName,
- unsigned int* width,
- unsigned int* height)
+NvmReader::Probe
+(io::DatasetInfo* pInfo)
 {
-  namespace bf = boost::filesystem;
-  bf::path imagePath(fileName);
-  if (!bf::exists(imagePath))
-  {
-    std::cerr << "Texture file " << imagePath << " not found!" << std::endl;
-    std::cerr << "Terminating." << std::endl;
-    exit(EXIT_FAILURE);
-  }
+  namespace iort = io::ReaderTools;
 
-  // open
-  std::ifstream jpegFile(imagePath.c_str());
-  if (!jpegFile.is_open())
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
   {
-    std::cerr << "Could not open texture file " << imagePath << "!" << std::endl;
+    std::cerr << "Could not open input file " << this->fInputPath << "!";
+    std::cerr << std::endl;
     std::cerr << "Terminating." << std::endl;
     exit(EXIT_FAILURE);
   }
+  pInfo->AddFile(inputFile.GetSize());
 
-  bool error = false;
-
-  char pBuffer[9];
-  unsigned int jpegFilePos = jpegFile.tellg();
-
-  // check first 4 bytes
-  jpegFile.read(pBuffer, 5);
-  if ((pBuffer[0] == static_cast<char>(0xFF)) &&
-      (pBuffer[1] == static_cast<char>(0xD8)) &&
-      (pBuffer[2] == static_cast<char>(0xFF)) &&
-      (pBuffer[3] == static_cast<char>(0xE0)))
-  {
-    jpegFilePos += 4;
-    jpegFile.seekg(jpegFilePos);
-    jpegFile.read(pBuffer, 7);
-
-    // check JFIF\0
-    if ((pBuffer[2] == 'J') && (pBuffer[3] == 'F') &&
-        (pBuffer[4] == 'I') && (pBuffer[5] == 'F') &&
-        (pBuffer[6] == 0x00))
-    {
-      unsigned int blockLength =
-        static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[0])) *
-          256 +
-        static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[1]));
-
-      while (jpegFile.good())
-      {
-        jpegFilePos += blockLength;
-        jpegFile.seekg(jpegFilePos);
-        jpegFile.read(pBuffer, 9);
-
-        // no beginning of a block
-        if (pBuffer[0] != static_cast<char>(0xFF))
-        {
-          error = true;
-          break;
-        }
-
-        // this is the FFC0 block containing the size
-        if (pBuffer[1] == static_cast<char>(0xC0))
-        {
-          *height =
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[5])) *
-              256 +
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[6]));
-          *width =
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[7])) *
-              256 +
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[8]));
-          break;
-        }
-        // proceed to the next block
-        else
-        {
-          jpegFilePos += 2;
-          jpegFile.seekg(jpegFilePos);
-          jpegFile.read(pBuffer, 2);
-
-          blockLength =
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[0])) *
-              256 +
-            static_cast<unsigned int>(static_cast<unsigned char>(pBuffer[1]));
-        }
-      }
-    }
-    else
-    {
-      error = true;
-    }
-  }
-  else
+  const std::string version(iort::Line<std::string>(inputFile).substr(0, 6));
+  if (version.compare("NVM_V3") != 0)
   {
-    error = true;
-  }
-
-  if (error)
-  {
-    std::cerr << "Error reading file " << imagePath << "!" << std::endl;
+    std::cerr << "Input file " << this->fInputPath << " not a valid NVM file!";
+    std::cerr << std::endl;
     std::cerr << "Terminating." << std::endl;
     exit(EXIT_FAILURE);
   }
-  if (jpegFile.is_open())
+  this->fVersion = io::NvmReader::kNvmVersion030;
+
+  pInfo->fNumTextures = iort::Line<unsigned int>(inputFile);
+  iort::Tokens textureTokens(" \t");
+  for (boost::uint64_t texNum = 0u; texNum < pInfo->fNumTextures; ++texNum)
   {
-    jpegFile.close();
+    iort::Line(inputFile, &textureTokens);
   }
+  pInfo->fNumPoints = iort::Line<unsigned int>(inputFile);
 }
 
 
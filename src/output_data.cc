@@ -56,6 +56,7 @@ namespace io
 OutputData::OutputData
 (const std::string& fileName)
 : fFileType(io::OutputData::kFileTypeInvalid)
+, fNumThreads(0u)
 , fFileName("")
 , fInfo("[none]")
 {
@@ -80,19 +81,25 @@ OutputData::Reset
   // create reader based on extension
   const bf::path outputPath(fileName);
 
-  // check if the parent directory exists
-  // otherwise create the directories up to the parent directory
-  if (!bf::exists(outputPath.parent_path()))
-  {
-	  bf::create_directories(outputPath.parent_path());
-  }
-
   if (outputPath.has_extension())
   {
 	if (outputPath.extension().compare(std::string(".rmv")) == 0)
 	{
 	  this->fFileType = io::OutputData::kFileTypeRMV;
 	}
+	else if (outputPath.extension().compare(std::string(".rmvb")) == 0)
+	{
+	  this->fFileType = io::OutputData::kFileTypeRMVB;
+	}
+  }
+
+  // check if the parent directory exists
+  // otherwise create the directories up to the parent directory
+  if (this->IsValid() &&
+      !outputPath.parent_path().empty() &&
+      !bf::exists(outputPath.parent_path()))
+  {
+	  bf::create_directories(outputPath.parent_path());
   }
 
   // if valid, create info string
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <cstring>
+
+#ifndef WIN32
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+#include <io/parallel_tools.h>
+
+
+namespace io
+{
+
+namespace ParallelTools
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Resolves a requested number of threads, 0 meaning one per hardware thread.
+////////////////////////////////////////////////////////////////////////////////
+unsigned int
+GetNumThreads
+(unsigned int requested)
+{
+  if (requested > 0u)
+  {
+    return requested;
+  }
+  const unsigned int hardwareThreads = boost::thread::hardware_concurrency();
+  return (hardwareThreads > 0u) ? hardwareThreads : 1u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Splits [begin, end) into ranges of about chunkSize bytes. Every range but
+/// the last one ends right after a line break.
+////////////////////////////////////////////////////////////////////////////////
+std::vector<io::ParallelTools::ByteRange>
+SplitLines
+(const char* begin,
+ const char* end,
+ std::size_t chunkSize)
+{
+  std::vector<io::ParallelTools::ByteRange> chunks;
+  const char* chunkBegin = begin;
+  while (chunkBegin != end)
+  {
+    const char* chunkEnd = end;
+    if (static_cast<std::size_t>(end - chunkBegin) > chunkSize)
+    {
+      const char* const lineEnd = static_cast<const char*>(
+        std::memchr(chunkBegin + chunkSize,
+                    '\n',
+                    static_cast<std::size_t>(end - chunkBegin - chunkSize)));
+      chunkEnd = (lineEnd == NULL) ? end : lineEnd + 1;
+    }
+    chunks.push_back(io::ParallelTools::ByteRange(chunkBegin, chunkEnd));
+    chunkBegin = chunkEnd;
+  }
+  return chunks;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Makes [begin, end) of a mapped file resident: asks the kernel to read it
+/// ahead and then touches every page, so the calling thread rather than the
+/// one parsing the range later waits for the disk. Harmless for memory that
+/// is not file backed.
+////////////////////////////////////////////////////////////////////////////////
+void
+Prefetch
+(const char* begin, const char* end)
+{
+  if (begin == end)
+  {
+    return;
+  }
+
+#ifndef WIN32
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const boost::uintptr_t firstPage =
+    reinterpret_cast<boost::uintptr_t>(begin) & ~(pageSize - 1u);
+  madvise(reinterpret_cast<void*>(firstPage),
+          reinterpret_cast<boost::uintptr_t>(end) - firstPage,
+          MADV_WILLNEED);
+#else
+  const std::size_t pageSize = 4096u;
+#endif
+
+  const std::size_t size = static_cast<std::size_t>(end - begin);
+  volatile char sink = 0;
+  for (std::size_t offset = 0u; offset < size; offset += pageSize)
+  {
+    sink ^= begin[offset];
+  }
+  sink ^= *(end - 1);
+}
+
+} // namespace ParallelTools
+
+
+} // namespace io
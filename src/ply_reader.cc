@@ -41,14 +41,19 @@
 //     DOI: 10.1109/ISVRI.2011.5759608
 //------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 #include <tr1/functional>
+#include <boost/endian/conversion.hpp>
 #include <boost/function.hpp>
-#include <boost/lambda/casts.hpp>
-#include <boost/lambda/lambda.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 
+#include <io/mapped_file.h>
 #include <io/ply_reader.h>
 
 #include <ply/ply.hpp>
@@ -64,11 +69,11 @@ namespace io
 PlyReader::PlyReader
 (const std::string& fileName)
 : fInputPath(fileName)
-, fAdapterOnBeginPoint(NULL)
-, fAdapterOnPointPosition(NULL)
-, fAdapterOnPointNormal(NULL)
-, fAdapterOnPointColour(NULL)
-, fAdapterOnEndPoint(NULL)
+, fNumRecords(0u)
+, fFlushRecords(NULL)
+, fBeginVertices(NULL)
+, fBeginFaces(NULL)
+, fFlushFaces(NULL)
 {
   namespace bf = boost::filesystem;
 
@@ -79,6 +84,8 @@ PlyReader::PlyReader
     std::cerr << "Terminating." << std::endl;
     exit(EXIT_FAILURE);
   }
+
+  this->ResetRecordLayout();
 }
 
 
@@ -97,19 +104,214 @@ PlyReader::~PlyReader
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the size of the PLY scalar type with the given name, 0 if there is
+/// no such type.
+////////////////////////////////////////////////////////////////////////////////
+static
+std::size_t
+GetPlyScalarSize
+(const std::string& typeName)
+{
+  if (typeName == "int8" || typeName == "char" ||
+      typeName == "uint8" || typeName == "uchar")
+  {
+    return 1u;
+  }
+  else if (typeName == "int16" || typeName == "short" ||
+           typeName == "uint16" || typeName == "ushort")
+  {
+    return 2u;
+  }
+  else if (typeName == "int32" || typeName == "int" ||
+           typeName == "uint32" || typeName == "uint" ||
+           typeName == "float32" || typeName == "float")
+  {
+    return 4u;
+  }
+  else if (typeName == "float64" || typeName == "double")
+  {
+    return 8u;
+  }
+  return 0u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the layout type of the PLY scalar type with the given name,
+/// kScalarTypeNone if there is no such type.
+////////////////////////////////////////////////////////////////////////////////
+PlyReader::VertexLayout::ScalarType
+PlyReader::GetScalarType
+(const std::string& typeName)
+{
+  if (typeName == "int8" || typeName == "char")
+  {
+    return VertexLayout::kScalarTypeInt8;
+  }
+  else if (typeName == "int16" || typeName == "short")
+  {
+    return VertexLayout::kScalarTypeInt16;
+  }
+  else if (typeName == "int32" || typeName == "int")
+  {
+    return VertexLayout::kScalarTypeInt32;
+  }
+  else if (typeName == "uint8" || typeName == "uchar")
+  {
+    return VertexLayout::kScalarTypeUint8;
+  }
+  else if (typeName == "uint16" || typeName == "ushort")
+  {
+    return VertexLayout::kScalarTypeUint16;
+  }
+  else if (typeName == "uint32" || typeName == "uint")
+  {
+    return VertexLayout::kScalarTypeUint32;
+  }
+  else if (typeName == "float32" || typeName == "float")
+  {
+    return VertexLayout::kScalarTypeFloat32;
+  }
+  else if (typeName == "float64" || typeName == "double")
+  {
+    return VertexLayout::kScalarTypeFloat64;
+  }
+  return VertexLayout::kScalarTypeNone;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the layout type of a scalar type of the generic parser.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ScalarType>
+PlyReader::VertexLayout::ScalarType
+PlyReader::GetScalarType
+()
+{
+  if (!std::numeric_limits<ScalarType>::is_integer)
+  {
+    return (sizeof(ScalarType) == 4u) ?
+      VertexLayout::kScalarTypeFloat32 : VertexLayout::kScalarTypeFloat64;
+  }
+  else if (std::numeric_limits<ScalarType>::is_signed)
+  {
+    return (sizeof(ScalarType) == 1u) ? VertexLayout::kScalarTypeInt8 :
+           (sizeof(ScalarType) == 2u) ? VertexLayout::kScalarTypeInt16 :
+                                        VertexLayout::kScalarTypeInt32;
+  }
+  return (sizeof(ScalarType) == 1u) ? VertexLayout::kScalarTypeUint8 :
+         (sizeof(ScalarType) == 2u) ? VertexLayout::kScalarTypeUint16 :
+                                      VertexLayout::kScalarTypeUint32;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the slot of a vertex property in PlyReader::VertexLayout, -1 for
+/// properties that are not read.
+////////////////////////////////////////////////////////////////////////////////
+static
+int
+GetPlyVertexSlot
+(const std::string& propertyName)
+{
+  static const char* const kSlotNames[] =
+    { "x", "y", "z", "nx", "ny", "nz", "red", "green", "blue" };
+
+  for (int slot = 0; slot < 9; ++slot)
+  {
+    if (propertyName == kSlotNames[slot] ||
+        (slot >= 6 && propertyName == std::string("diffuse_") + kSlotNames[slot]))
+    {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns true for the names of the vertex index lists of faces.
+////////////////////////////////////////////////////////////////////////////////
+static
+bool
+IsPlyFaceIndexList
+(const std::string& propertyName)
+{
+  return (propertyName == "vertex_indices" || propertyName == "vertex_index");
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Prepares the vertex records for the generic parser: every slot may hold
+/// any scalar type, slots without a property keep their defaults.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::ResetRecordLayout
+()
+{
+  this->fRecordLayout.fFormat = VertexLayout::kFormatBinaryLittleEndian;
+  this->fRecordLayout.fIsSwapped = false;
+  this->fRecordLayout.fNumVertices = 0u;
+  this->fRecordLayout.fNumProperties = 0u;
+  this->fRecordLayout.fRecordSize =
+    VertexLayout::kNumSlots * VertexLayout::kMaxScalarSize;
+  this->fRecordLayout.fVerticesOffset = 0u;
+  this->fRecordLayout.fVerticesLine = 0u;
+  for (unsigned int slot = 0u; slot < VertexLayout::kNumSlots; ++slot)
+  {
+    this->fRecordLayout.fTypes[slot] = VertexLayout::kScalarTypeNone;
+    this->fRecordLayout.fOffsets[slot] = 0u;
+  }
+  this->fRecords.clear();
+  this->fNumRecords = 0u;
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Registers callbacks for the individual elements of the ply file
 ////////////////////////////////////////////////////////////////////////////////
 io::PlyReader::ElementCallbackTuple
 PlyReader::ElementDefinitionCallback
-(const std::string& element_name, std::size_t)
+(const std::string& element_name, std::size_t count)
 {
   if (element_name == "vertex")
   {
+    if (this->fBeginVertices)
+    {
+      this->fBeginVertices(count);
+    }
+    this->ResetRecordLayout();
     return io::PlyReader::ElementCallbackTuple(
       std::tr1::bind(&io::PlyReader::VertexBeginCallback, this),
       std::tr1::bind(&io::PlyReader::VertexEndCallback, this) );
   }
+  else if (element_name == "face")
+  {
+    if (this->fBeginFaces)
+    {
+      this->fBeginFaces(count);
+    }
+    return ElementCallbackTuple(NULL, NULL);
+  }
   else
   {
     return ElementCallbackTuple(NULL, NULL);
@@ -122,55 +324,30 @@ PlyReader::ElementDefinitionCallback
 
 ////////////////////////////////////////////////////////////////////////////////
 /// With this method the correct function pointers for handling the elements'
-/// attributes are determined.
+/// attributes are determined. Vertex attributes of any scalar type are
+/// stored as they are in the record of the current vertex.
 ///
 /// \note This method is similar to the one used in the examples of ply-loader.
 ////////////////////////////////////////////////////////////////////////////////
-template <>
-std::tr1::function<void (ply::float32)>
-PlyReader::ScalarPropertyDefinitionCallback<ply::float32>
+template <typename ScalarType>
+std::tr1::function<void (ScalarType)>
+PlyReader::ScalarPropertyDefinitionCallback
 (const std::string& elementName,
  const std::string& propertyName)
 {
-  namespace bl = boost::lambda;
-
   if (elementName == "vertex")
   {
-    if (propertyName == "x")
-    {
-      return boost::function<void (float)>(bl::var(this->fPositionX) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "y")
-    {
-      return boost::function<void (float)>(bl::var(this->fPositionY) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "z")
-    {
-      return boost::function<void (float)>(bl::var(this->fPositionZ) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "nx")
-    {
-      return boost::function<void (float)>(bl::var(this->fNormalX) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "ny")
-    {
-      return boost::function<void (float)>(bl::var(this->fNormalY) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "nz")
+    const int slot = GetPlyVertexSlot(propertyName);
+    if (slot >= 0)
     {
-      return boost::function<void (float)>(bl::var(this->fNormalZ) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "red" || propertyName == "diffuse_red")
-    {
-      return boost::function<void (float)>(bl::var(this->fColourR) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "green" || propertyName == "diffuse_green")
-    {
-      return boost::function<void (float)>(bl::var(this->fColourG) = bl::ll_static_cast<double>(bl::_1));
-    }
-    else if (propertyName == "blue" || propertyName == "diffuse_blue")
-    {
-      return boost::function<void (float)>(bl::var(this->fColourB) = bl::ll_static_cast<double>(bl::_1));
+      const std::size_t offset = slot * VertexLayout::kMaxScalarSize;
+      this->fRecordLayout.fTypes[slot] = PlyReader::GetScalarType<ScalarType>();
+      this->fRecordLayout.fOffsets[slot] = offset;
+      return std::tr1::bind(
+        &io::PlyReader::ScalarPropertyCallback<ScalarType>,
+        this,
+        offset,
+        std::tr1::placeholders::_1);
     }
   }
 
@@ -182,36 +359,82 @@ PlyReader::ScalarPropertyDefinitionCallback<ply::float32>
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// With this method the correct function pointers for handling the elements'
-/// attributes are determined.
 ///
-/// \note This method is similar to the one used in the examples of ply-loader.
 ////////////////////////////////////////////////////////////////////////////////
-template <>
-std::tr1::function<void (ply::uint8)>
-PlyReader::ScalarPropertyDefinitionCallback<ply::uint8>
+template <typename ScalarType>
+void
+PlyReader::ScalarPropertyCallback
+(std::size_t offset, ScalarType value)
+{
+  std::memcpy(&this->fRecords[this->fNumRecords *
+                              this->fRecordLayout.fRecordSize + offset],
+              &value, sizeof(value));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::VertexBeginCallback
+()
+{
+  this->fRecords.resize((this->fNumRecords + 1u) *
+                        this->fRecordLayout.fRecordSize);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Completes the current record and hands full batches on for decoding.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::VertexEndCallback
+()
+{
+  ++this->fNumRecords;
+  if (this->fFlushRecords != NULL &&
+      this->fNumRecords == io::kPointBatchSize)
+  {
+    this->fFlushRecords();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Collects the vertex indices of faces, one list per face; other lists are
+/// skipped.
+////////////////////////////////////////////////////////////////////////////////
+template <typename SizeType, typename IndexType>
+std::tr1::tuple<std::tr1::function<void (SizeType)>,
+                std::tr1::function<void (IndexType)>,
+                std::tr1::function<void ()> >
+PlyReader::ListPropertyDefinitionCallback
 (const std::string& elementName,
  const std::string& propertyName)
 {
-  namespace bl = boost::lambda;
-
-  if (elementName == "vertex")
+  typedef std::tr1::tuple<std::tr1::function<void (SizeType)>,
+                          std::tr1::function<void (IndexType)>,
+                          std::tr1::function<void ()> > ListCallbackTuple;
+  if (elementName == "face" && IsPlyFaceIndexList(propertyName))
   {
-    if (propertyName == "red" || propertyName == "diffuse_red")
-    {
-      return boost::function<void (unsigned int)>(bl::var(this->fColourR) = bl::ll_static_cast<double>(bl::_1) / 255.0);
-    }
-    else if (propertyName == "green" || propertyName == "diffuse_green")
-    {
-      return boost::function<void (unsigned int)>(bl::var(this->fColourG) = bl::ll_static_cast<double>(bl::_1) / 255.0);
-    }
-    else if (propertyName == "blue" || propertyName == "diffuse_blue")
-    {
-      return boost::function<void (unsigned int)>(bl::var(this->fColourB) = bl::ll_static_cast<double>(bl::_1) / 255.0);
-    }
+    return ListCallbackTuple(
+      std::tr1::bind(&io::PlyReader::FaceBeginCallback, this),
+      std::tr1::bind(&io::PlyReader::FaceIndexCallback<IndexType>,
+                     this,
+                     std::tr1::placeholders::_1),
+      std::tr1::bind(&io::PlyReader::FaceEndCallback, this));
   }
 
-  return 0;
+  return ListCallbackTuple(NULL, NULL, NULL);
 }
 
 
@@ -221,19 +444,30 @@ PlyReader::ScalarPropertyDefinitionCallback<ply::uint8>
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////
+template <typename IndexType>
 void
-PlyReader::VertexBeginCallback
+PlyReader::FaceIndexCallback
+(IndexType index)
+{
+  this->fFaces.AddIndex(static_cast<unsigned int>(index));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the pending vertices on first, so that adapters receive all points
+/// before the faces referring to them.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::FaceBeginCallback
 ()
 {
-  this->fPositionX = 0.0;
-  this->fPositionY = 0.0;
-  this->fPositionZ = 0.0;
-  this->fNormalX = 0.0;
-  this->fNormalY = 0.0;
-  this->fNormalZ = 0.0;
-  this->fColourR = 1.0;
-  this->fColourG = 1.0;
-  this->fColourB = 1.0;
+  if (this->fFlushRecords != NULL && this->fNumRecords > 0u)
+  {
+    this->fFlushRecords();
+  }
 }
 
 
@@ -241,29 +475,16 @@ PlyReader::VertexBeginCallback
 
 
 ////////////////////////////////////////////////////////////////////////////////
-///
+/// Completes the current face and hands full batches on.
 ////////////////////////////////////////////////////////////////////////////////
 void
-PlyReader::VertexEndCallback
+PlyReader::FaceEndCallback
 ()
 {
-  if (this->fAdapterOnBeginPoint != NULL &&
-      this->fAdapterOnPointPosition != NULL &&
-      this->fAdapterOnPointNormal != NULL &&
-      this->fAdapterOnPointColour != NULL &&
-      this->fAdapterOnEndPoint != NULL)
+  this->fFaces.EndFace();
+  if (this->fFaces.GetSize() == io::kFaceBatchSize)
   {
-    this->fAdapterOnBeginPoint();
-    this->fAdapterOnPointPosition(this->fPositionX,
-                                  this->fPositionY,
-                                  this->fPositionZ);
-    this->fAdapterOnPointNormal(this->fNormalX,
-                                this->fNormalY,
-                                this->fNormalZ);
-    this->fAdapterOnPointColour(this->fColourR,
-                                this->fColourG,
-                                this->fColourB);
-    this->fAdapterOnEndPoint();
+    this->FlushFaces();
   }
 }
 
@@ -271,6 +492,65 @@ PlyReader::VertexEndCallback
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the complete faces collected so far to the adapter. The indices of
+/// a face the parser gave up on are dropped.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::FlushFaces
+()
+{
+  this->fFaces.DropOpenFace();
+  if (this->fFlushFaces != NULL && !this->fFaces.IsEmpty())
+  {
+    this->fFlushFaces(this->fFaces);
+  }
+  this->fFaces.Clear();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Registers ScalarPropertyDefinitionCallback() for one scalar type.
+////////////////////////////////////////////////////////////////////////////////
+template <typename ScalarType, typename Callbacks>
+void
+PlyReader::AddScalarPropertyDefinitionCallback
+(Callbacks* pCallbacks)
+{
+  ply::at<ScalarType>(*pCallbacks) = std::tr1::bind(
+    &io::PlyReader::ScalarPropertyDefinitionCallback<ScalarType>,
+    this,
+    std::tr1::placeholders::_1,
+    std::tr1::placeholders::_2);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Registers ListPropertyDefinitionCallback() for one pair of size and index
+/// type.
+////////////////////////////////////////////////////////////////////////////////
+template <typename SizeType, typename IndexType, typename Callbacks>
+void
+PlyReader::AddListPropertyDefinitionCallback
+(Callbacks* pCallbacks)
+{
+  ply::at<SizeType, IndexType>(*pCallbacks) = std::tr1::bind(
+    &io::PlyReader::ListPropertyDefinitionCallback<SizeType, IndexType>,
+    this,
+    std::tr1::placeholders::_1,
+    std::tr1::placeholders::_2);
+}
+
+
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Provides a callback for messages from the ply parsser
 ////////////////////////////////////////////////////////////////////////////////
@@ -297,9 +577,8 @@ void
 PlyReader::ParseFile
 ()
 {
-  std::ifstream ifstream;
-  ifstream.open(this->fInputPath.c_str());
-  if (!ifstream.is_open())
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
   {
     std::cerr << "PlyReader: "
     << this->fInputPath
@@ -351,21 +630,815 @@ PlyReader::ParseFile
     std::tr1::placeholders::_1,
     std::tr1::placeholders::_2));
 
-  // register scalar property definition callbacks
+  // register scalar property definition callbacks for all scalar types
   ply::ply_parser::scalar_property_definition_callbacks_type spdc;
-  ply::at<ply::float32>(spdc) = std::tr1::bind(
-    &io::PlyReader::ScalarPropertyDefinitionCallback<ply::float32>,
-    this,
-    std::tr1::placeholders::_1,
-    std::tr1::placeholders::_2);
-  ply::at<ply::uint8>(spdc) = std::tr1::bind(
-    &io::PlyReader::ScalarPropertyDefinitionCallback<ply::uint8>,
-    this,
-    std::tr1::placeholders::_1,
-    std::tr1::placeholders::_2);
+  this->AddScalarPropertyDefinitionCallback<ply::int8>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::int16>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::int32>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::uint8>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::uint16>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::uint32>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::float32>(&spdc);
+  this->AddScalarPropertyDefinitionCallback<ply::float64>(&spdc);
   plyParser.scalar_property_definition_callbacks(spdc);
 
-  plyParser.parse(ifstream);
+  // register list property definition callbacks for all integer lists
+  ply::ply_parser::list_property_definition_callbacks_type lpdc;
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::int8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::int16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::int32>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::uint8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::uint16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint8, ply::uint32>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::int8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::int16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::int32>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::uint8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::uint16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint16, ply::uint32>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::int8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::int16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::int32>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::uint8>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::uint16>(&lpdc);
+  this->AddListPropertyDefinitionCallback<ply::uint32, ply::uint32>(&lpdc);
+  plyParser.list_property_definition_callbacks(lpdc);
+
+  // let the parser read the mapped file in place
+  boost::iostreams::stream<boost::iostreams::array_source> inputStream(
+    inputFile.GetBegin(), inputFile.GetSize());
+  plyParser.parse(inputStream);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// A property as declared in the header of a PLY file. fCountTypeName is
+/// empty unless the property is a list.
+////////////////////////////////////////////////////////////////////////////////
+struct PlyPropertyHeader
+{
+  std::string fName;
+  std::string fTypeName;
+  std::string fCountTypeName;
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// An element as declared in the header of a PLY file.
+////////////////////////////////////////////////////////////////////////////////
+struct PlyElementHeader
+{
+  std::string fName;
+  std::size_t fCount;
+  std::vector<PlyPropertyHeader> fProperties;
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the header of a PLY file, leaving the read position behind
+/// end_header. Returns false for headers it cannot make sense of; the
+/// generic parser handles (or reports) those.
+////////////////////////////////////////////////////////////////////////////////
+static
+bool
+ReadPlyHeader
+(io::MappedFile& inputFile,
+ std::string* pFormatName,
+ std::vector<PlyElementHeader>* pElements)
+{
+  namespace iort = io::ReaderTools;
+
+  iort::Tokens headerTokens(" \t\r");
+  const char* begin = NULL;
+  const char* end = NULL;
+  if (!iort::NonCommentLine(inputFile, &begin, &end))
+  {
+    return false;
+  }
+  headerTokens.Assign(begin, end);
+  if (iort::Token<std::string>(headerTokens) != "ply" ||
+      !iort::NonCommentLine(inputFile, &begin, &end))
+  {
+    return false;
+  }
+  headerTokens.Assign(begin, end);
+  if (iort::Token<std::string>(headerTokens) != "format")
+  {
+    return false;
+  }
+  *pFormatName = iort::Token<std::string>(headerTokens);
+
+  while (iort::NonCommentLine(inputFile, &begin, &end))
+  {
+    headerTokens.Assign(begin, end);
+    const std::string keyword(iort::Token<std::string>(headerTokens));
+    if (keyword == "end_header")
+    {
+      return true;
+    }
+    else if (keyword == "element")
+    {
+      PlyElementHeader element;
+      element.fName = iort::Token<std::string>(headerTokens);
+      element.fCount = iort::Token<unsigned int>(headerTokens);
+      pElements->push_back(element);
+    }
+    else if (keyword == "property" && !pElements->empty())
+    {
+      PlyPropertyHeader property;
+      property.fTypeName = iort::Token<std::string>(headerTokens);
+      if (property.fTypeName == "list")
+      {
+        property.fCountTypeName = iort::Token<std::string>(headerTokens);
+        property.fTypeName = iort::Token<std::string>(headerTokens);
+      }
+      property.fName = iort::Token<std::string>(headerTokens);
+      if (GetPlyScalarSize(property.fTypeName) == 0u ||
+          (!property.fCountTypeName.empty() &&
+           GetPlyScalarSize(property.fCountTypeName) == 0u))
+      {
+        return false;
+      }
+      pElements->back().fProperties.push_back(property);
+    }
+    else if (keyword != "comment" && keyword != "obj_info")
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the size of the binary records of an element. Returns false
+/// if they have no fixed size, i.e. for elements with list properties.
+////////////////////////////////////////////////////////////////////////////////
+static
+bool
+GetPlyElementSize
+(const PlyElementHeader& element,
+ std::size_t* pSize)
+{
+  *pSize = 0u;
+  for (std::size_t property = 0u;
+       property < element.fProperties.size();
+       ++property)
+  {
+    const std::size_t scalarSize =
+      GetPlyScalarSize(element.fProperties[property].fTypeName);
+    if (!element.fProperties[property].fCountTypeName.empty() ||
+        scalarSize == 0u)
+    {
+      return false;
+    }
+    *pSize += scalarSize;
+  }
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Skips the elements [first, last): binary ones need a fixed size, ASCII
+/// ones take one line each. Returns false if they cannot be skipped.
+////////////////////////////////////////////////////////////////////////////////
+static
+bool
+SkipPlyElements
+(const std::vector<PlyElementHeader>& elements,
+ std::size_t first,
+ std::size_t last,
+ bool isAscii,
+ std::size_t* pSkippedSize,
+ std::size_t* pSkippedLines)
+{
+  *pSkippedSize = 0u;
+  *pSkippedLines = 0u;
+  for (std::size_t element = first; element < last; ++element)
+  {
+    std::size_t elementSize = 0u;
+    if (!GetPlyElementSize(elements[element], &elementSize) && !isAscii)
+    {
+      return false;
+    }
+    *pSkippedSize += elements[element].fCount * elementSize;
+    *pSkippedLines += elements[element].fCount;
+  }
+  return true;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the header of an ASCII or binary file and determines where the
+/// vertex attributes lie within the vertex records or lines, and where the
+/// faces lie, if any. Returns false if the file cannot be read directly:
+/// files without vertices, vertices with list
+/// properties, faces before the vertices, faces with properties besides
+/// their vertex indices, binary elements with list properties before the
+/// faces, and binary files too short for all vertices. The generic parser
+/// handles (or reports) those.
+////////////////////////////////////////////////////////////////////////////////
+bool
+PlyReader::ReadLayout
+(io::MappedFile& inputFile,
+ VertexLayout* pVertexLayout,
+ FaceLayout* pFaceLayout)
+{
+  namespace iort = io::ReaderTools;
+
+  pVertexLayout->fFormat = VertexLayout::kFormatAscii;
+  pVertexLayout->fIsSwapped = false;
+  pVertexLayout->fNumVertices = 0u;
+  pVertexLayout->fNumProperties = 0u;
+  pVertexLayout->fRecordSize = 0u;
+  pVertexLayout->fVerticesOffset = 0u;
+  pVertexLayout->fVerticesLine = 0u;
+  for (unsigned int slot = 0u; slot < VertexLayout::kNumSlots; ++slot)
+  {
+    pVertexLayout->fTypes[slot] = VertexLayout::kScalarTypeNone;
+    pVertexLayout->fOffsets[slot] = 0u;
+  }
+  pFaceLayout->fNumFaces = 0u;
+  pFaceLayout->fFacesOffset = 0u;
+  pFaceLayout->fSkippedLines = 0u;
+  pFaceLayout->fFacesLine = 0u;
+  pFaceLayout->fIsSwapped = false;
+  pFaceLayout->fCountType = VertexLayout::kScalarTypeNone;
+  pFaceLayout->fIndexType = VertexLayout::kScalarTypeNone;
+
+  std::string formatName;
+  std::vector<PlyElementHeader> elements;
+  try
+  {
+    if (!ReadPlyHeader(inputFile, &formatName, &elements))
+    {
+      return false;
+    }
+  }
+  catch (const boost::bad_lexical_cast&)
+  {
+    return false;
+  }
+
+  if (formatName == "binary_little_endian")
+  {
+    pVertexLayout->fFormat = VertexLayout::kFormatBinaryLittleEndian;
+    pVertexLayout->fIsSwapped =
+      (boost::endian::order::native != boost::endian::order::little);
+  }
+  else if (formatName == "binary_big_endian")
+  {
+    pVertexLayout->fFormat = VertexLayout::kFormatBinaryBigEndian;
+    pVertexLayout->fIsSwapped =
+      (boost::endian::order::native != boost::endian::order::big);
+  }
+  else if (formatName != "ascii")
+  {
+    return false;
+  }
+  const bool isAscii = (pVertexLayout->fFormat == VertexLayout::kFormatAscii);
+  const std::size_t headerSize =
+    static_cast<std::size_t>(inputFile.GetPosition() - inputFile.GetBegin());
+  const std::size_t numHeaderLines = static_cast<std::size_t>(
+    std::count(inputFile.GetBegin(), inputFile.GetPosition(), '\n'));
+
+  // vertices
+  std::size_t vertexElement = 0u;
+  while (vertexElement < elements.size() &&
+         elements[vertexElement].fName != "vertex")
+  {
+    if (elements[vertexElement].fName == "face")
+    {
+      return false;
+    }
+    ++vertexElement;
+  }
+  std::size_t skippedSize = 0u;
+  std::size_t skippedLines = 0u;
+  if (vertexElement == elements.size() ||
+      !SkipPlyElements(elements, 0u, vertexElement, isAscii,
+                       &skippedSize, &skippedLines))
+  {
+    return false;
+  }
+
+  const PlyElementHeader& vertices = elements[vertexElement];
+  for (std::size_t property = 0u;
+       property < vertices.fProperties.size();
+       ++property)
+  {
+    const PlyPropertyHeader& header = vertices.fProperties[property];
+    const std::size_t scalarSize = GetPlyScalarSize(header.fTypeName);
+    if (!header.fCountTypeName.empty() || scalarSize == 0u)
+    {
+      return false;
+    }
+
+    const int slot = GetPlyVertexSlot(header.fName);
+    if (slot >= 0)
+    {
+      // field index in ASCII files, byte offset in binary ones
+      pVertexLayout->fTypes[slot] = PlyReader::GetScalarType(header.fTypeName);
+      pVertexLayout->fOffsets[slot] =
+        isAscii ? property : pVertexLayout->fRecordSize;
+    }
+    pVertexLayout->fRecordSize += scalarSize;
+  }
+  pVertexLayout->fNumVertices = vertices.fCount;
+  pVertexLayout->fNumProperties = vertices.fProperties.size();
+  if (isAscii && pVertexLayout->fNumProperties == 0u)
+  {
+    return false;
+  }
+
+  // generic parser line number of the first vertex
+  pVertexLayout->fVerticesLine = numHeaderLines + skippedLines + 1u;
+  if (isAscii)
+  {
+    for (std::size_t line = 0u; line < skippedLines; ++line)
+    {
+      if (inputFile.IsAtEnd())
+      {
+        return false;
+      }
+      iort::SkipLine(inputFile);
+    }
+    pVertexLayout->fVerticesOffset = static_cast<std::size_t>(
+      inputFile.GetPosition() - inputFile.GetBegin());
+  }
+  else
+  {
+    pVertexLayout->fVerticesOffset = headerSize + skippedSize;
+    if (pVertexLayout->fVerticesOffset +
+        pVertexLayout->fNumVertices * pVertexLayout->fRecordSize >
+        inputFile.GetSize())
+    {
+      return false;
+    }
+  }
+
+  // faces, the first element of that name behind the vertices
+  std::size_t faceElement = vertexElement + 1u;
+  while (faceElement < elements.size() && elements[faceElement].fName != "face")
+  {
+    ++faceElement;
+  }
+  if (faceElement == elements.size())
+  {
+    return true;
+  }
+  for (std::size_t element = faceElement + 1u;
+       element < elements.size();
+       ++element)
+  {
+    if (elements[element].fName == "face")
+    {
+      return false;
+    }
+  }
+
+  const PlyElementHeader& faces = elements[faceElement];
+  if (faces.fProperties.size() != 1u ||
+      !IsPlyFaceIndexList(faces.fProperties[0].fName) ||
+      !SkipPlyElements(elements, vertexElement + 1u, faceElement, isAscii,
+                       &skippedSize, &skippedLines))
+  {
+    return false;
+  }
+  const VertexLayout::ScalarType countType =
+    PlyReader::GetScalarType(faces.fProperties[0].fCountTypeName);
+  const VertexLayout::ScalarType indexType =
+    PlyReader::GetScalarType(faces.fProperties[0].fTypeName);
+  if (countType < VertexLayout::kScalarTypeUint8 ||
+      countType > VertexLayout::kScalarTypeUint32 ||
+      indexType < VertexLayout::kScalarTypeInt8 ||
+      indexType > VertexLayout::kScalarTypeUint32)
+  {
+    return false;
+  }
+
+  pFaceLayout->fNumFaces = faces.fCount;
+  pFaceLayout->fIsSwapped = pVertexLayout->fIsSwapped;
+  pFaceLayout->fCountType = countType;
+  pFaceLayout->fIndexType = indexType;
+  pFaceLayout->fSkippedLines = skippedLines;
+  pFaceLayout->fFacesOffset = pVertexLayout->fVerticesOffset +
+    pVertexLayout->fNumVertices * pVertexLayout->fRecordSize + skippedSize;
+
+  // the generic parser reports errors in binary data at the end of the
+  // header
+  pFaceLayout->fFacesLine = isAscii ?
+    pVertexLayout->fVerticesLine + pVertexLayout->fNumVertices +
+    skippedLines : numHeaderLines;
+  return (isAscii || pFaceLayout->fFacesOffset <= inputFile.GetSize());
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the faces behind the vertices directly, batch by batch. position
+/// is where the ASCII vertices ended; binary faces are found by their
+/// offset. Malformed faces are reported like the generic parser does; the
+/// faces before them are kept.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::LoadFaces
+(const io::MappedFile& inputFile,
+ const char* position,
+ bool isAscii,
+ const FaceLayout& layout)
+{
+  if (layout.fCountType == VertexLayout::kScalarTypeNone)
+  {
+    return;
+  }
+
+  const char* const end = inputFile.GetEnd();
+  if (isAscii)
+  {
+    for (std::size_t line = 0u;
+         line < layout.fSkippedLines && position != end;
+         ++line)
+    {
+      const char* const lineEnd = static_cast<const char*>(
+        std::memchr(position, '\n', static_cast<std::size_t>(end - position)));
+      position = (lineEnd == NULL) ? end : lineEnd + 1;
+    }
+  }
+  else
+  {
+    position = inputFile.GetBegin() + layout.fFacesOffset;
+  }
+
+  if (this->fBeginFaces != NULL)
+  {
+    this->fBeginFaces(layout.fNumFaces);
+  }
+
+  // grows with the number of indices per face
+  std::vector<const char*> fieldBounds(32u);
+  for (std::size_t first = 0u; first < layout.fNumFaces; first += kFaceBatchSize)
+  {
+    const std::size_t numFaces =
+      std::min(kFaceBatchSize, layout.fNumFaces - first);
+    const bool isValid = PlyReader::ReadFaces(&position, end, numFaces,
+                                              isAscii, layout, &fieldBounds,
+                                              &this->fFaces);
+    const std::size_t numRead = this->fFaces.GetSize();
+    this->FlushFaces();
+    if (!isValid)
+    {
+      const std::size_t lineNumber = !isAscii ? layout.fFacesLine :
+        layout.fFacesLine + first + numRead -
+        ((position == end) ? 1u : 0u);
+      this->MessageCallBack("Ply-Error", this->fInputPath.string(),
+                            lineNumber, "parse error");
+      return;
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads numFaces faces with the file's index type into pBatch.
+////////////////////////////////////////////////////////////////////////////////
+bool
+PlyReader::ReadFaces
+(const char** pPosition,
+ const char* end,
+ std::size_t numFaces,
+ bool isAscii,
+ const FaceLayout& layout,
+ std::vector<const char*>* pFieldBounds,
+ io::FaceBatch* pBatch)
+{
+  const VertexLayout::ScalarType type = layout.fIndexType;
+  if (type == VertexLayout::kScalarTypeInt32)
+  {
+    return PlyReader::ReadFaces<boost::int32_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeUint32)
+  {
+    return PlyReader::ReadFaces<boost::uint32_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeInt16)
+  {
+    return PlyReader::ReadFaces<boost::int16_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeUint16)
+  {
+    return PlyReader::ReadFaces<boost::uint16_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeInt8)
+  {
+    return PlyReader::ReadFaces<boost::int8_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeUint8)
+  {
+    return PlyReader::ReadFaces<boost::uint8_t>(
+      pPosition, end, numFaces, isAscii, layout, pFieldBounds, pBatch);
+  }
+  return false;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads numFaces faces with the file's count type into pBatch.
+////////////////////////////////////////////////////////////////////////////////
+template <typename IndexType>
+bool
+PlyReader::ReadFaces
+(const char** pPosition,
+ const char* end,
+ std::size_t numFaces,
+ bool isAscii,
+ const FaceLayout& layout,
+ std::vector<const char*>* pFieldBounds,
+ io::FaceBatch* pBatch)
+{
+  const VertexLayout::ScalarType type = layout.fCountType;
+  if (isAscii)
+  {
+    const std::size_t maxCount =
+      (type == VertexLayout::kScalarTypeUint8) ?
+        std::numeric_limits<boost::uint8_t>::max() :
+      (type == VertexLayout::kScalarTypeUint16) ?
+        std::numeric_limits<boost::uint16_t>::max() :
+        std::numeric_limits<boost::uint32_t>::max();
+    return PlyReader::ScanFaces<IndexType>(
+      pPosition, end, numFaces, maxCount, pFieldBounds, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeUint8)
+  {
+    return PlyReader::DecodeFaces<boost::uint8_t, IndexType>(
+      pPosition, end, numFaces, layout.fIsSwapped, pBatch);
+  }
+  else if (type == VertexLayout::kScalarTypeUint16)
+  {
+    return PlyReader::DecodeFaces<boost::uint16_t, IndexType>(
+      pPosition, end, numFaces, layout.fIsSwapped, pBatch);
+  }
+  return PlyReader::DecodeFaces<boost::uint32_t, IndexType>(
+    pPosition, end, numFaces, layout.fIsSwapped, pBatch);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Decodes binary faces. Consecutive faces with the same number of indices,
+/// typically all faces of a triangle mesh, have a fixed stride: their counts
+/// are verified in one pass, and their indices are copied in a second one
+/// without looking at the counts again. Swapped 32 bit indices are swapped
+/// for the whole run at once.
+////////////////////////////////////////////////////////////////////////////////
+template <typename CountType, typename IndexType>
+bool
+PlyReader::DecodeFaces
+(const char** pPosition,
+ const char* end,
+ std::size_t numFaces,
+ bool isSwapped,
+ io::FaceBatch* pBatch)
+{
+  const char* position = *pPosition;
+  std::size_t face = 0u;
+  while (face < numFaces &&
+         static_cast<std::size_t>(end - position) >= sizeof(CountType))
+  {
+    CountType count;
+    std::memcpy(&count, position, sizeof(count));
+    if (isSwapped)
+    {
+      boost::endian::endian_reverse_inplace(count);
+    }
+    const std::size_t faceSize =
+      sizeof(CountType) + static_cast<std::size_t>(count) * sizeof(IndexType);
+    const std::size_t maxRun =
+      std::min(numFaces - face,
+               static_cast<std::size_t>(end - position) / faceSize);
+    if (maxRun == 0u)
+    {
+      break;
+    }
+    std::size_t run = 1u;
+    while (run < maxRun &&
+           std::memcmp(position + run * faceSize, position,
+                       sizeof(CountType)) == 0)
+    {
+      ++run;
+    }
+
+    const std::size_t firstIndex = pBatch->fIndices.size();
+    pBatch->fIndices.resize(firstIndex + run * count);
+    for (std::size_t runFace = 0u; runFace < run; ++runFace)
+    {
+      const char* const pSource =
+        position + runFace * faceSize + sizeof(CountType);
+      const std::size_t faceIndex = firstIndex + runFace * count;
+      if (sizeof(IndexType) == sizeof(unsigned int))
+      {
+        if (count > 0u)
+        {
+          std::memcpy(&pBatch->fIndices[faceIndex], pSource,
+                      count * sizeof(IndexType));
+        }
+      }
+      else
+      {
+        for (std::size_t index = 0u; index < count; ++index)
+        {
+          IndexType value;
+          std::memcpy(&value, pSource + index * sizeof(IndexType),
+                      sizeof(value));
+          if (isSwapped)
+          {
+            boost::endian::endian_reverse_inplace(value);
+          }
+          pBatch->fIndices[faceIndex + index] =
+            static_cast<unsigned int>(value);
+        }
+      }
+      pBatch->fOffsets.push_back(
+        static_cast<unsigned int>(faceIndex + count));
+    }
+    if (isSwapped && sizeof(IndexType) == sizeof(unsigned int) &&
+        run * count > 0u)
+    {
+      io::ByteOrder::SwapScalars(&pBatch->fIndices[firstIndex], run * count,
+                                 sizeof(unsigned int));
+    }
+    position += run * faceSize;
+    face += run;
+  }
+
+  *pPosition = position;
+  return (face == numFaces);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Scans ASCII faces, one per line: the number of indices, then the indices.
+/// Like the generic parser, the line must hold nothing else.
+////////////////////////////////////////////////////////////////////////////////
+template <typename IndexType>
+bool
+PlyReader::ScanFaces
+(const char** pPosition,
+ const char* end,
+ std::size_t numFaces,
+ std::size_t maxCount,
+ std::vector<const char*>* pFieldBounds,
+ io::FaceBatch* pBatch)
+{
+  namespace iort = io::ReaderTools;
+
+  std::size_t face = 0u;
+  const char* begin = *pPosition;
+  try
+  {
+    for (; face < numFaces && begin != end; ++face)
+    {
+      const char* lineEnd = static_cast<const char*>(
+        std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+      const char* const next = (lineEnd == NULL) ? end : lineEnd + 1;
+      if (lineEnd == NULL)
+      {
+        lineEnd = end;
+      }
+
+      std::size_t maxFields = pFieldBounds->size() / 2u;
+      std::size_t numFields =
+        iort::SplitFields(begin, lineEnd, maxFields, &(*pFieldBounds)[0]);
+      while (numFields > maxFields)
+      {
+        maxFields *= 2u;
+        pFieldBounds->resize(2u * maxFields);
+        numFields =
+          iort::SplitFields(begin, lineEnd, maxFields, &(*pFieldBounds)[0]);
+      }
+      if (numFields == 0u)
+      {
+        break;
+      }
+
+      const char* const* pField = &(*pFieldBounds)[0];
+      const std::size_t count =
+        PlyReader::ParseScalar<boost::uint32_t>(pField[0], pField[1]);
+      if (count > maxCount || count + 1u != numFields)
+      {
+        break;
+      }
+      for (std::size_t field = 1u; field < numFields; ++field)
+      {
+        pBatch->AddIndex(static_cast<unsigned int>(
+          PlyReader::ParseScalar<IndexType>(pField[2u * field],
+                                            pField[2u * field + 1u])));
+      }
+      pBatch->EndFace();
+      begin = next;
+    }
+  }
+  catch (const boost::bad_lexical_cast&)
+  {
+    pBatch->DropOpenFace();
+  }
+
+  *pPosition = begin;
+  return (face == numFaces);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the number of vertices from the header. The body is not touched,
+/// whatever its format.
+////////////////////////////////////////////////////////////////////////////////
+void
+PlyReader::Probe
+(io::DatasetInfo* pInfo)
+{
+  namespace iort = io::ReaderTools;
+
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
+  {
+    std::cerr << "PlyReader: "
+    << this->fInputPath
+    << ": no such file or directory"
+    << std::endl;
+
+    exit(EXIT_FAILURE);
+  }
+  pInfo->AddFile(inputFile.GetSize());
+
+  if (iort::Line<std::string>(inputFile).compare("ply") != 0)
+  {
+    std::cerr << "Input file " << this->fInputPath << " not a valid PLY file!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  iort::Tokens headerTokens(" \t\r");
+  const char* begin = NULL;
+  const char* end = NULL;
+  while (iort::NonCommentLine(inputFile, &begin, &end))
+  {
+    headerTokens.Assign(begin, end);
+    const std::string keyword(iort::Token<std::string>(headerTokens));
+    if (keyword.compare("end_header") == 0)
+    {
+      return;
+    }
+    else if (keyword.compare("element") == 0 &&
+             iort::Token<std::string>(headerTokens).compare("vertex") == 0)
+    {
+      pInfo->fNumPoints = iort::Token<unsigned int>(headerTokens);
+    }
+  }
+
+  std::cerr << "Input file " << this->fInputPath << " has no end_header!";
+  std::cerr << std::endl;
+  std::cerr << "Terminating." << std::endl;
+  exit(EXIT_FAILURE);
 }
 
 
@@ -0,0 +1,301 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <io/rmv_format.h>
+
+
+namespace io
+{
+
+namespace RmvFormat
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// Determines the offsets of all sections and the file size from the
+/// counts, the scalar type and the size of the textures section.
+////////////////////////////////////////////////////////////////////////////////
+void
+ComputeLayout
+(Header* pHeader)
+{
+  const std::size_t scalarSize = pHeader->fScalarType;
+  const std::size_t numPoints = pHeader->fNumPoints;
+  const std::size_t numTexCoords = pHeader->fNumTexCoords;
+
+  std::size_t offset = AlignOffset(kHeaderSize);
+  pHeader->fTexturesOffset = offset;
+  offset = AlignOffset(offset + pHeader->fTexturesSize);
+  pHeader->fPositionsOffset = offset;
+  offset = AlignOffset(offset + 3u * numPoints * scalarSize);
+  pHeader->fColoursOffset = offset;
+  offset = AlignOffset(offset + 3u * numPoints * scalarSize);
+  pHeader->fConfidencesOffset = offset;
+  offset = AlignOffset(offset + numPoints * scalarSize);
+  pHeader->fTexCoordOffsetsOffset = offset;
+  offset = AlignOffset(offset + (numPoints + 1u) * sizeof(boost::uint64_t));
+  pHeader->fTexCoordIdsOffset = offset;
+  offset = AlignOffset(offset + numTexCoords * sizeof(boost::uint32_t));
+  pHeader->fTexCoordsOffset = offset;
+  offset += 2u * numTexCoords * scalarSize;
+  pHeader->fFileSize = offset;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes magic and header, kHeaderSize bytes.
+////////////////////////////////////////////////////////////////////////////////
+void
+WriteHeader
+(const Header& header, char* pTarget)
+{
+  std::memset(pTarget, 0, kHeaderSize);
+  std::memcpy(pTarget, kMagic, kMagicSize);
+  char* target = pTarget + kMagicSize;
+
+  StoreLittle(header.fScalarType, target);
+  target += 8u;
+  StoreLittle(header.fNumTextures, target);
+  target += 8u;
+  StoreLittle(header.fNumPoints, target);
+  target += 8u;
+  StoreLittle(header.fNumTexCoords, target);
+  target += 8u;
+  for (unsigned int coord = 0u; coord < 3u; ++coord, target += 8u)
+  {
+    StoreLittle(header.fBoundingBoxMin[coord], target);
+  }
+  for (unsigned int coord = 0u; coord < 3u; ++coord, target += 8u)
+  {
+    StoreLittle(header.fBoundingBoxMax[coord], target);
+  }
+  const boost::uint64_t offsets[] =
+  {
+    header.fTexturesOffset,
+    header.fTexturesSize,
+    header.fPositionsOffset,
+    header.fColoursOffset,
+    header.fConfidencesOffset,
+    header.fTexCoordOffsetsOffset,
+    header.fTexCoordIdsOffset,
+    header.fTexCoordsOffset,
+    header.fFileSize
+  };
+  for (unsigned int offset = 0u; offset < 9u; ++offset, target += 8u)
+  {
+    StoreLittle(offsets[offset], target);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads magic and header from [begin, end). Returns false if the data is no
+/// RMV_2 header or if its sections do not match the counts or do not fit
+/// into [begin, end).
+////////////////////////////////////////////////////////////////////////////////
+bool
+ReadHeader
+(const char* begin, const char* end, Header* pHeader)
+{
+  const std::size_t size = static_cast<std::size_t>(end - begin);
+  if (size < kHeaderSize || std::memcmp(begin, kMagic, kMagicSize) != 0)
+  {
+    return false;
+  }
+
+  const char* source = begin + kMagicSize;
+  LoadLittle(source, &pHeader->fScalarType);
+  source += 8u;
+  LoadLittle(source, &pHeader->fNumTextures);
+  source += 8u;
+  LoadLittle(source, &pHeader->fNumPoints);
+  source += 8u;
+  LoadLittle(source, &pHeader->fNumTexCoords);
+  source += 8u;
+  for (unsigned int coord = 0u; coord < 3u; ++coord, source += 8u)
+  {
+    LoadLittle(source, &pHeader->fBoundingBoxMin[coord]);
+  }
+  for (unsigned int coord = 0u; coord < 3u; ++coord, source += 8u)
+  {
+    LoadLittle(source, &pHeader->fBoundingBoxMax[coord]);
+  }
+  boost::uint64_t* offsets[] =
+  {
+    &pHeader->fTexturesOffset,
+    &pHeader->fTexturesSize,
+    &pHeader->fPositionsOffset,
+    &pHeader->fColoursOffset,
+    &pHeader->fConfidencesOffset,
+    &pHeader->fTexCoordOffsetsOffset,
+    &pHeader->fTexCoordIdsOffset,
+    &pHeader->fTexCoordsOffset,
+    &pHeader->fFileSize
+  };
+  for (unsigned int offset = 0u; offset < 9u; ++offset, source += 8u)
+  {
+    LoadLittle(source, offsets[offset]);
+  }
+
+  if (pHeader->fScalarType != kScalarTypeFloat32 &&
+      pHeader->fScalarType != kScalarTypeFloat64)
+  {
+    return false;
+  }
+  // every point and tex coord takes more than one byte, which also keeps
+  // the computation of the layout from overflowing
+  if (pHeader->fFileSize > size ||
+      pHeader->fNumPoints >= size ||
+      pHeader->fNumTexCoords >= size ||
+      pHeader->fTexturesSize >= size)
+  {
+    return false;
+  }
+
+  // sections are laid out as written by ComputeLayout
+  Header layout(*pHeader);
+  ComputeLayout(&layout);
+  return (layout.fTexturesOffset == pHeader->fTexturesOffset &&
+          layout.fPositionsOffset == pHeader->fPositionsOffset &&
+          layout.fColoursOffset == pHeader->fColoursOffset &&
+          layout.fConfidencesOffset == pHeader->fConfidencesOffset &&
+          layout.fTexCoordOffsetsOffset == pHeader->fTexCoordOffsetsOffset &&
+          layout.fTexCoordIdsOffset == pHeader->fTexCoordIdsOffset &&
+          layout.fTexCoordsOffset == pHeader->fTexCoordsOffset &&
+          layout.fFileSize == pHeader->fFileSize);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Appends the record of one texture: id, width, height and length of the
+/// file name as uint32, position and direction as float64, the file name
+/// and zeros up to the next multiple of 8 bytes.
+////////////////////////////////////////////////////////////////////////////////
+void
+AppendTexture
+(const TextureRecord& texture, std::vector<char>* pSection)
+{
+  const std::size_t nameLength = texture.fFileName.size();
+  const std::size_t recordSize =
+    ((4u * 4u + 6u * 8u + nameLength + 7u) / 8u) * 8u;
+  const std::size_t first = pSection->size();
+  pSection->resize(first + recordSize, '\0');
+
+  char* target = &(*pSection)[first];
+  StoreLittle(static_cast<boost::uint32_t>(texture.fId), target);
+  StoreLittle(static_cast<boost::uint32_t>(texture.fWidth), target + 4u);
+  StoreLittle(static_cast<boost::uint32_t>(texture.fHeight), target + 8u);
+  StoreLittle(static_cast<boost::uint32_t>(nameLength), target + 12u);
+  target += 16u;
+  for (unsigned int coord = 0u; coord < 3u; ++coord, target += 8u)
+  {
+    StoreLittle(texture.fPosition[coord], target);
+  }
+  for (unsigned int coord = 0u; coord < 3u; ++coord, target += 8u)
+  {
+    StoreLittle(texture.fDirection[coord], target);
+  }
+  if (nameLength > 0u)
+  {
+    std::memcpy(target, texture.fFileName.data(), nameLength);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the texture record at position. Returns the position of the next
+/// record or NULL if the record does not fit into [position, end).
+////////////////////////////////////////////////////////////////////////////////
+const char*
+ReadTexture
+(const char* position, const char* end, TextureRecord* pTexture)
+{
+  const std::size_t fixedSize = 4u * 4u + 6u * 8u;
+  if (static_cast<std::size_t>(end - position) < fixedSize)
+  {
+    return NULL;
+  }
+
+  boost::uint32_t values[4];
+  for (unsigned int value = 0u; value < 4u; ++value)
+  {
+    LoadLittle(position + 4u * value, &values[value]);
+  }
+  const std::size_t nameLength = values[3];
+  const std::size_t recordSize = ((fixedSize + nameLength + 7u) / 8u) * 8u;
+  if (static_cast<std::size_t>(end - position) < recordSize)
+  {
+    return NULL;
+  }
+
+  pTexture->fId = values[0];
+  pTexture->fWidth = values[1];
+  pTexture->fHeight = values[2];
+  const char* source = position + 16u;
+  for (unsigned int coord = 0u; coord < 3u; ++coord, source += 8u)
+  {
+    LoadLittle(source, &pTexture->fPosition[coord]);
+  }
+  for (unsigned int coord = 0u; coord < 3u; ++coord, source += 8u)
+  {
+    LoadLittle(source, &pTexture->fDirection[coord]);
+  }
+  pTexture->fFileName.assign(source, nameLength);
+  return position + recordSize;
+}
+
+} // namespace RmvFormat
+
+
+} // namespace io
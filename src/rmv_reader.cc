@@ -55,9 +55,11 @@ namespace io
 ///
 ////////////////////////////////////////////////////////////////////////////////
 RmvReader::RmvReader
-(const std::string& fileName)
+(const std::string& fileName,
+ const io::LoadOptions& loadOptions)
 : fInputPath(fileName)
 , fVersion(io::RmvReader::kRmvVersionInvalid)
+, fLoadOptions(loadOptions)
 {
   namespace bf = boost::filesystem;
 
@@ -83,4 +85,74 @@ RmvReader::~RmvReader
 }
 
 
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reads the counts without parsing any point. Text files announce the number
+/// of points after the textures, so only the texture lines are skipped.
+/// Binary files store counts and bounding box in their header.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvReader::Probe
+(io::DatasetInfo* pInfo)
+{
+  namespace iort = io::ReaderTools;
+  namespace rf = io::RmvFormat;
+
+  io::MappedFile inputFile(this->fInputPath.string());
+  if (!inputFile.IsOpen())
+  {
+    std::cerr << "Could not open input file " << this->fInputPath << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  pInfo->AddFile(inputFile.GetSize());
+
+  const std::string version(iort::Line<std::string>(inputFile));
+  if (version.compare("RMV_1") == 0)
+  {
+    this->fVersion = io::RmvReader::kRmvVersion010;
+
+    pInfo->fNumTextures = iort::Line<unsigned int>(inputFile);
+    iort::Tokens textureTokens(";");
+    for (boost::uint64_t texNum = 0u; texNum < pInfo->fNumTextures; ++texNum)
+    {
+      iort::Line(inputFile, &textureTokens);
+    }
+    pInfo->fNumPoints = iort::Line<unsigned int>(inputFile);
+  }
+  else if (version.compare("RMV_2") == 0)
+  {
+    this->fVersion = io::RmvReader::kRmvVersion020;
+
+    rf::Header header;
+    if (!rf::ReadHeader(inputFile.GetBegin(), inputFile.GetEnd(), &header))
+    {
+      std::cerr << "Input file " << this->fInputPath << " has an invalid header!";
+      std::cerr << std::endl;
+      std::cerr << "Terminating." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    pInfo->fNumTextures = header.fNumTextures;
+    pInfo->fNumPoints = header.fNumPoints;
+    pInfo->fHasBoundingBox = (header.fNumPoints > 0u);
+    for (unsigned int coord = 0u; coord < 3u; ++coord)
+    {
+      pInfo->fBoundingBoxMin[coord] = header.fBoundingBoxMin[coord];
+      pInfo->fBoundingBoxMax[coord] = header.fBoundingBoxMax[coord];
+    }
+  }
+  else
+  {
+    std::cerr << "Input file " << this->fInputPath << " not a valid RMV file!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
 } // namespace io
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <cstdlib>
+
+#include <io/rmv_stream_writer.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+RmvStreamWriter::RmvStreamWriter
+(const std::string& fileName)
+: fOutputPath(fileName)
+, fOut()
+, fState(kStateCreated)
+, fNumTexturesPosition(0)
+, fNumPointsPosition(0)
+, fNumTextures(0u)
+, fNumPoints(0u)
+{
+  namespace bf = boost::filesystem;
+
+  // check if the parent directory exists
+  // otherwise create the directories up to the parent directory
+  if (!this->fOutputPath.parent_path().empty() &&
+      !bf::exists(this->fOutputPath.parent_path()))
+  {
+    bf::create_directories(this->fOutputPath.parent_path());
+  }
+
+  this->fOut.Open(this->fOutputPath.string());
+  if (!this->fOut.IsOpen())
+  {
+    std::cerr << "Could not open output file " << this->fOutputPath << "!";
+    std::cerr << std::endl;
+    std::cerr << "Terminating." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Finishes the file unless this happened before.
+////////////////////////////////////////////////////////////////////////////////
+RmvStreamWriter::~RmvStreamWriter
+()
+{
+  if (this->fState != kStateFinished)
+  {
+    this->Finish();
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes the file header. Called by the first AddTexture() if necessary.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::BeginTextures
+()
+{
+  if (this->fState != kStateCreated)
+  {
+    this->Fail("Textures have been begun before");
+  }
+
+  // write version of RMV file
+  this->fOut.Put(std::string("RMV_1"));
+  this->fOut.Put('\n');
+
+  // additional empty line (see file format, wiki)
+  this->fOut.Put('\n');
+
+  this->PutCountPlaceholder(&this->fNumTexturesPosition);
+  this->fState = kStateTextures;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Ends the textures. Called by the first AddPoint() if necessary.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::BeginPoints
+()
+{
+  if (this->fState == kStateCreated)
+  {
+    this->BeginTextures();
+  }
+  if (this->fState != kStateTextures)
+  {
+    this->Fail("Points have been begun before");
+  }
+
+  // additional empty line (see file format, wiki)
+  this->fOut.Put('\n');
+
+  this->PutCountPlaceholder(&this->fNumPointsPosition);
+  this->fState = kStatePoints;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands everything added so far to the file. The counts in the file are
+/// not updated before Finish().
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::Flush
+()
+{
+  this->fOut.Flush();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fills in the counts and closes the file.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::Finish
+()
+{
+  if (this->fState == kStateFinished)
+  {
+    this->Fail("The file has been finished before");
+  }
+  if (this->fState != kStatePoints)
+  {
+    this->BeginPoints();
+  }
+
+  this->PatchCount(this->fNumTexturesPosition, this->fNumTextures);
+  this->PatchCount(this->fNumPointsPosition, this->fNumPoints);
+  this->fOut.Close();
+  this->fState = kStateFinished;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes a line of kCountWidth zeros and returns where it starts.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::PutCountPlaceholder
+(std::streampos* pPosition)
+{
+  *pPosition = this->fOut.Tell();
+  this->fOut.Put(std::string(kCountWidth, '0'));
+  this->fOut.Put('\n');
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replaces a placeholder by the count, padded with leading zeros.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::PatchCount
+(std::streampos position, unsigned int count)
+{
+  std::string digits(kCountWidth, '0');
+  for (std::size_t digit = kCountWidth; count != 0u; count /= 10u)
+  {
+    digits[--digit] = static_cast<char>('0' + count % 10u);
+  }
+  this->fOut.Overwrite(position, digits);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvStreamWriter::Fail
+(const std::string& message) const
+{
+  std::cerr << message << " in " << this->fOutputPath << "!" << std::endl;
+  std::cerr << "Terminating." << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+
+} // namespace io
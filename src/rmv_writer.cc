@@ -41,6 +41,7 @@
 //     DOI: 10.1109/ISVRI.2011.5759608
 //------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cstdlib>
 
 #include <boost/filesystem.hpp>
@@ -55,15 +56,17 @@ namespace io
 ///
 ////////////////////////////////////////////////////////////////////////////////
 RmvWriter::RmvWriter
-(const std::string& fileName, RmvVersion rmvVersion)
+(const std::string& fileName, RmvVersion rmvVersion, unsigned int numThreads)
 : fOutputPath(fileName)
 , fVersion(rmvVersion)
+, fNumThreads(numThreads)
 {
   namespace bf = boost::filesystem;
 
   // check if the parent directory exists
   // otherwise create the directories up to the parent directory
-  if (!bf::exists(this->fOutputPath.parent_path()))
+  if (!this->fOutputPath.parent_path().empty() &&
+      !bf::exists(this->fOutputPath.parent_path()))
   {
 	  bf::create_directories(this->fOutputPath.parent_path());
   }
@@ -82,4 +85,24 @@ RmvWriter::~RmvWriter
 }
 
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes zeros up to the given offset.
+////////////////////////////////////////////////////////////////////////////////
+void
+RmvWriter::PadTo
+(std::size_t offset, std::ostream& output, std::size_t* pPosition)
+{
+  static const char zeros[io::RmvFormat::kSectionAlignment] = { 0 };
+  while (*pPosition < offset)
+  {
+    const std::size_t numBytes =
+      std::min(offset - *pPosition, io::RmvFormat::kSectionAlignment);
+    output.write(zeros, numBytes);
+    *pPosition += numBytes;
+  }
+}
+
+
 } // namespace io
@@ -0,0 +1,241 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include <io/text_emitter.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+TextEmitter::TextEmitter
+()
+: fOutput()
+, fIsInMemory(true)
+, fBuffer()
+, fSize(0u)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+TextEmitter::TextEmitter
+(const std::string& fileName)
+: fOutput(fileName.c_str())
+, fIsInMemory(false)
+, fBuffer(kBufferSize)
+, fSize(0u)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+TextEmitter::~TextEmitter
+()
+{
+  this->Close();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Closes the current file, if any, and continues writing to fileName.
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Open
+(const std::string& fileName)
+{
+  this->Close();
+  this->fOutput.open(fileName.c_str());
+  this->fIsInMemory = false;
+  this->fBuffer.resize(kBufferSize);
+  this->fSize = 0u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Appends text collected by another (in-memory) emitter. Large blocks are
+/// written to the file directly instead of being copied into the buffer.
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Put
+(const TextEmitter& text)
+{
+  if (text.GetSize() == 0u)
+  {
+    return;
+  }
+
+  if (!this->fIsInMemory &&
+      this->fSize + text.GetSize() > this->fBuffer.size())
+  {
+    this->Flush();
+    if (text.GetSize() >= this->fBuffer.size())
+    {
+      if (this->fOutput.is_open())
+      {
+        this->fOutput.write(text.GetData(), text.GetSize());
+      }
+      return;
+    }
+  }
+
+  char* pOut = this->Reserve(text.GetSize());
+  std::copy(text.GetData(), text.GetData() + text.GetSize(), pOut);
+  this->fSize += text.GetSize();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enlarges the buffer of an in-memory emitter by at least numBytes.
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Grow
+(std::size_t numBytes)
+{
+  this->fBuffer.resize(
+    std::max(2u * this->fBuffer.size(), this->fSize + numBytes));
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Returns the file position following the text put so far.
+////////////////////////////////////////////////////////////////////////////////
+std::streampos
+TextEmitter::Tell
+()
+{
+  this->Flush();
+  return this->fOutput.tellp();
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replaces text that has been written before (see Tell()), e.g. to fill in
+/// a count known only at the end. The replacement must not be longer than
+/// the text it replaces.
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Overwrite
+(std::streampos position, const std::string& text)
+{
+  this->Flush();
+  const std::streampos end = this->fOutput.tellp();
+  this->fOutput.seekp(position);
+  this->fOutput.write(text.data(), text.size());
+  this->fOutput.seekp(end);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Hands the buffered characters to the file. Blocks of this size bypass
+/// the stream's own buffer. In-memory emitters keep their text.
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Flush
+()
+{
+  if (this->fIsInMemory)
+  {
+    return;
+  }
+
+  if (this->fSize > 0u && this->fOutput.is_open())
+  {
+    this->fOutput.write(&this->fBuffer[0], this->fSize);
+    this->fOutput.flush();
+  }
+  this->fSize = 0u;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+TextEmitter::Close
+()
+{
+  this->Flush();
+  if (this->fOutput.is_open())
+  {
+    this->fOutput.close();
+  }
+}
+
+
+} // namespace io
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <io/parallel_tools.h>
+#include <io/work_stealing_pool.h>
+
+
+namespace io
+{
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+WorkStealingPool::WorkStealingPool
+(unsigned int numThreads)
+: fNumThreads(io::ParallelTools::GetNumThreads(numThreads))
+, fpTasks(NULL)
+, fQueues(new Queue[this->fNumThreads])
+, fIsAborted(false)
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+WorkStealingPool::~WorkStealingPool
+()
+{
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Runs all tasks and returns once they are finished. With a single thread
+/// the tasks run in order on the calling thread. Otherwise the first
+/// exception thrown by a task is rethrown after all threads have stopped.
+////////////////////////////////////////////////////////////////////////////////
+void
+WorkStealingPool::Run
+(const std::vector<Task>& tasks)
+{
+  if (this->fNumThreads == 1u || tasks.size() < 2u)
+  {
+    for (std::size_t task = 0u; task < tasks.size(); ++task)
+    {
+      tasks[task](0u);
+    }
+    return;
+  }
+
+  this->fpTasks = &tasks;
+  this->fError = boost::exception_ptr();
+  this->fIsAborted = false;
+  for (std::size_t task = 0u; task < tasks.size(); ++task)
+  {
+    this->fQueues[task % this->fNumThreads].fTasks.push_back(task);
+  }
+
+  boost::thread_group workers;
+  for (unsigned int thread = 0u; thread < this->fNumThreads; ++thread)
+  {
+    workers.create_thread(
+      boost::bind(&io::WorkStealingPool::Work, this, thread));
+  }
+  workers.join_all();
+
+  for (unsigned int thread = 0u; thread < this->fNumThreads; ++thread)
+  {
+    this->fQueues[thread].fTasks.clear();
+  }
+  this->fpTasks = NULL;
+  if (this->fError)
+  {
+    boost::rethrow_exception(this->fError);
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+void
+WorkStealingPool::Work
+(unsigned int thread)
+{
+  std::size_t task = 0u;
+  while (this->TakeTask(thread, &task))
+  {
+    try
+    {
+      (*this->fpTasks)[task](thread);
+    }
+    catch (...)
+    {
+      boost::lock_guard<boost::mutex> lock(this->fErrorMutex);
+      if (!this->fError)
+      {
+        this->fError = boost::current_exception();
+      }
+      this->fIsAborted = true;
+      return;
+    }
+  }
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Takes the next task from the own queue or steals one from another thread.
+/// Returns false once all queues are empty. No tasks are added while running,
+/// so an empty set of queues stays empty.
+////////////////////////////////////////////////////////////////////////////////
+bool
+WorkStealingPool::TakeTask
+(unsigned int thread, std::size_t* pTask)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(this->fErrorMutex);
+    if (this->fIsAborted)
+    {
+      return false;
+    }
+  }
+
+  {
+    Queue& ownQueue = this->fQueues[thread];
+    boost::lock_guard<boost::mutex> lock(ownQueue.fMutex);
+    if (!ownQueue.fTasks.empty())
+    {
+      *pTask = ownQueue.fTasks.back();
+      ownQueue.fTasks.pop_back();
+      return true;
+    }
+  }
+
+  for (unsigned int offset = 1u; offset < this->fNumThreads; ++offset)
+  {
+    Queue& victim = this->fQueues[(thread + offset) % this->fNumThreads];
+    boost::lock_guard<boost::mutex> lock(victim.fMutex);
+    if (!victim.fTasks.empty())
+    {
+      *pTask = victim.fTasks.front();
+      victim.fTasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+
+} // namespace io
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+// avigle-io -- common io classes/tools
+//
+// Developed during the research project AVIGLE
+// which was part of the Hightech.NRW research program
+// funded by the ministry for Innovation, Science, Research and Technology
+// of the German state Northrhine-Westfalia, and by the European Union.
+//
+// Copyright (c) 2010--2013, Tom Vierjahn et al.
+//------------------------------------------------------------------------------
+//                                License
+//
+// This library/program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// If you are using this library/program in a project, work or publication,
+// please cite [1,2].
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+//                                References
+//
+// [1] S. Rohde, N. Goddemeier, C. Wietfeld, F. Steinicke, K. Hinrichs,
+//     T. Ostermann, J. Holsten, D. Moormann:
+//     "AVIGLE: A System of Systems Concept for an
+//      Avionic Digital Service Platform based on
+//      Micro Unmanned Aerial Vehicles".
+//     In Proc. IEEE Int'l Conf. Systems Man and Cybernetics (SMC),
+//     pp. 459--466. 2010. DOI: 10.1109/ICSMC.2010.5641767
+// [2] S. Strothoff, D. Feldmann, F. Steinicke, T. Vierjahn, S. Mostafawy:
+//     "Interactive generation of virtual environments using MUAVs".
+//     In Proc. IEEE Int. Symp. VR Innovations, pp. 89--96, 2011.
+//     DOI: 10.1109/ISVRI.2011.5759608
+//------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <io/input_data.h>
+#include <io/load_options.h>
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Checks the extension only; unlike io::OutputData, no directories are
+/// created for a file that is rejected.
+////////////////////////////////////////////////////////////////////////////////
+static
+bool
+IsSupportedOutput
+(const std::string& fileName)
+{
+  const boost::filesystem::path extension(
+    boost::filesystem::path(fileName).extension());
+  return (extension.compare(std::string(".rmv")) == 0 ||
+          extension.compare(std::string(".rmvb")) == 0);
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+static
+void
+PrintUsage
+(const char* programName)
+{
+  std::cerr << "Usage: " << programName
+            << " [-j threads] [-u] [-d] [-s WxH] [-S sizes] [-c cache]"
+            << " <input> <output>" << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Converts any supported data set into an RMV file"
+            << " (.rmv or .rmvb)." << std::endl;
+  std::cerr << "  -j threads  number of parsing threads,"
+            << " 0 for one per core (default 0)" << std::endl;
+  std::cerr << "  -u          do not preserve the point order" << std::endl;
+  std::cerr << "  -d          convert in double precision" << std::endl;
+  std::cerr << "  -s WxH      size of all images, the images are not read"
+            << std::endl;
+  std::cerr << "  -S sizes    file listing \"<image> <width> <height>\""
+            << " per line" << std::endl;
+  std::cerr << "  -c cache    file caching the sizes read from images"
+            << std::endl;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////
+int
+main
+(int argc, char** argv)
+{
+  io::LoadOptions loadOptions;
+  loadOptions.fNumThreads = 0u;
+  bool isDoublePrecision = false;
+
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; ++arg)
+  {
+    if (std::strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+    {
+      loadOptions.fNumThreads =
+        static_cast<unsigned int>(std::atoi(argv[++arg]));
+    }
+    else if (std::strcmp(argv[arg], "-u") == 0)
+    {
+      loadOptions.fPreserveOrder = false;
+    }
+    else if (std::strcmp(argv[arg], "-d") == 0)
+    {
+      isDoublePrecision = true;
+    }
+    else if (std::strcmp(argv[arg], "-s") == 0 && arg + 1 < argc &&
+             std::sscanf(argv[arg + 1], "%ux%u",
+                         &loadOptions.fImageWidth,
+                         &loadOptions.fImageHeight) == 2)
+    {
+      ++arg;
+    }
+    else if (std::strcmp(argv[arg], "-S") == 0 && arg + 1 < argc)
+    {
+      loadOptions.fImageSizesFileName = argv[++arg];
+    }
+    else if (std::strcmp(argv[arg], "-c") == 0 && arg + 1 < argc)
+    {
+      loadOptions.fImageCacheFileName = argv[++arg];
+    }
+    else
+    {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc - arg != 2)
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  io::InputData input(argv[arg]);
+  if (!input.IsValid())
+  {
+    std::cerr << "Unsupported input file " << argv[arg] << "!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  input.SetLoadOptions(loadOptions);
+
+  const std::string outputFileName(argv[arg + 1]);
+  if (!IsSupportedOutput(outputFileName))
+  {
+    std::cerr << "Unsupported output file " << outputFileName << "!"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (isDoublePrecision)
+  {
+    input.Convert<double>(outputFileName);
+  }
+  else
+  {
+    input.Convert<float>(outputFileName);
+  }
+
+  return EXIT_SUCCESS;
+}